@@ -0,0 +1,94 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t align_size(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static char* get_chunk_data(arena_chunk_t* chunk) {
+    // Data starts at the first cache line after the chunk header
+    uintptr_t address = (uintptr_t)(chunk + 1);
+    return (char*)((address + ARENA_ALIGNMENT - 1) & ~(uintptr_t)(ARENA_ALIGNMENT - 1));
+}
+
+static arena_chunk_t* create_chunk(size_t size) {
+    arena_chunk_t* chunk = (arena_chunk_t*)malloc(sizeof(arena_chunk_t) + ARENA_ALIGNMENT + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    size = align_size(size > 0 ? size : 1);
+
+    // Move on to the next chunk kept from earlier frames, or add a new one, if the current one is full
+    while (arena->current == NULL || arena->current->used + size > arena->current->size) {
+        arena_chunk_t* next = arena->current ? arena->current->next : arena->first;
+
+        if (next == NULL) {
+            size_t chunk_size = ARENA_MIN_CHUNK_SIZE;
+            if (arena->current && arena->current->size * 2 > chunk_size) chunk_size = arena->current->size * 2;
+            if (size > chunk_size) chunk_size = size;
+
+            next = create_chunk(chunk_size);
+            if (arena->current) {
+                arena->current->next = next;
+            } else {
+                arena->first = next;
+            }
+        }
+
+        next->used = 0;
+        arena->current = next;
+    }
+
+    void* memory = get_chunk_data(arena->current) + arena->current->used;
+    arena->current->used += size;
+    arena->last_allocation = memory;
+    return memory;
+}
+
+void* arena_grow(arena_t* arena, void* memory, size_t old_size, size_t new_size) {
+    // The most recent allocation can grow in place if its chunk still has room
+    if (memory != NULL && memory == arena->last_allocation) {
+        size_t offset = (char*)memory - get_chunk_data(arena->current);
+        size_t size = align_size(new_size);
+
+        if (offset + size <= arena->current->size) {
+            arena->current->used = offset + size;
+            return memory;
+        }
+    }
+
+    void* grown = arena_alloc(arena, new_size);
+    if (memory != NULL && old_size > 0) {
+        memcpy(grown, memory, old_size);
+    }
+    return grown;
+}
+
+void arena_reset(arena_t* arena) {
+    // Everything handed out so far is released at once; the chunks are kept and each one is
+    // rewound by arena_alloc when the next frame moves on to it
+    if (arena->first != NULL) {
+        arena->first->used = 0;
+    }
+    arena->current = arena->first;
+    arena->last_allocation = NULL;
+}
+
+void arena_free(arena_t* arena) {
+    arena_chunk_t* chunk = arena->first;
+    while (chunk != NULL) {
+        arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->last_allocation = NULL;
+}
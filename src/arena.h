@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Every allocation starts on its own cache line
+#define ARENA_ALIGNMENT 64
+
+// Smallest chunk requested from the system when the arena runs out of space
+#define ARENA_MIN_CHUNK_SIZE (256 * 1024)
+
+typedef struct arena_chunk {
+    struct arena_chunk* next;
+    size_t size;                // usable bytes after the aligned start of the chunk
+    size_t used;                // bytes handed out so far this frame
+} arena_chunk_t;
+
+// Linear allocator for data that only lives until the end of the frame
+typedef struct {
+    arena_chunk_t* first;
+    arena_chunk_t* current;
+    void* last_allocation;      // most recent allocation, which can still grow in place
+} arena_t;
+
+void* arena_alloc(arena_t* arena, size_t size);
+void* arena_grow(arena_t* arena, void* memory, size_t old_size, size_t new_size);
+void arena_reset(arena_t* arena);
+void arena_free(arena_t* arena);
+
+#endif
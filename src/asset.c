@@ -0,0 +1,69 @@
+#include "asset.h"
+#include <stdlib.h>
+#include <string.h>
+#include "array.h"
+
+void* acquire_asset(asset_t** cache, char* path) {
+    // Look for an asset that is already resident and add a reference to it
+    for (int i = 0; i < array_length(*cache); i++) {
+        asset_t* asset = &(*cache)[i];
+
+        if (asset->path != NULL && strcmp(asset->path, path) == 0) {
+            asset->ref_count++;
+            return asset->data;
+        }
+    }
+
+    return NULL;
+}
+
+void add_asset(asset_t** cache, char* path, void* data) {
+    asset_t asset = {
+        .path = (char*)malloc(strlen(path) + 1),
+        .data = data,
+        .ref_count = 1
+    };
+    strcpy(asset.path, path);
+
+    // Reuse the slot of a released asset before growing the cache
+    for (int i = 0; i < array_length(*cache); i++) {
+        if ((*cache)[i].path == NULL) {
+            (*cache)[i] = asset;
+            return;
+        }
+    }
+
+    array_push(*cache, asset);
+}
+
+void* release_asset(asset_t** cache, void* data) {
+    for (int i = 0; i < array_length(*cache); i++) {
+        asset_t* asset = &(*cache)[i];
+
+        if (asset->path == NULL || asset->data != data) {
+            continue;
+        }
+
+        // The last user going away frees the slot and hands the data back to be destroyed
+        asset->ref_count--;
+        if (asset->ref_count == 0) {
+            free(asset->path);
+            asset->path = NULL;
+            asset->data = NULL;
+            return data;
+        }
+
+        return NULL;
+    }
+
+    return NULL;
+}
+
+void free_asset_cache(asset_t** cache) {
+    for (int i = 0; i < array_length(*cache); i++) {
+        free((*cache)[i].path);
+    }
+
+    array_free(*cache);
+    *cache = NULL;
+}
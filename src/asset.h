@@ -0,0 +1,15 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+typedef struct {
+    char* path;     // file the asset was loaded from (NULL for a free slot)
+    void* data;     // loaded asset data shared by all users
+    int ref_count;  // number of users holding the asset
+} asset_t;
+
+void* acquire_asset(asset_t** cache, char* path);
+void add_asset(asset_t** cache, char* path, void* data);
+void* release_asset(asset_t** cache, void* data);
+void free_asset_cache(asset_t** cache);
+
+#endif
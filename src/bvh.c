@@ -0,0 +1,156 @@
+#include "bvh.h"
+#include <stdlib.h>
+#include <math.h>
+#include "array.h"
+#include "instance.h"
+#include "clipping.h"
+
+static bvh_node_t* nodes = NULL;
+static int* instance_order = NULL;
+static int num_built_instances = 0;
+
+// Axis used to compare instance centers while sorting
+static int sort_axis = 0;
+
+static float get_axis(vec3_t v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+static vec3_t get_instance_center(int index) {
+    instance_t* instance = get_instance(index);
+    return vec3_mul(vec3_add(instance->bounds_min, instance->bounds_max), 0.5);
+}
+
+static int compare_instance_centers(const void* a, const void* b) {
+    float center_a = get_axis(get_instance_center(*(int*)a), sort_axis);
+    float center_b = get_axis(get_instance_center(*(int*)b), sort_axis);
+    return (center_a > center_b) - (center_a < center_b);
+}
+
+static void fit_leaf(bvh_node_t* node) {
+    instance_t* first = get_instance(instance_order[node->first_instance]);
+    node->min = first->bounds_min;
+    node->max = first->bounds_max;
+
+    for (int i = node->first_instance + 1; i < node->first_instance + node->num_instances; i++) {
+        instance_t* instance = get_instance(instance_order[i]);
+        node->min = vec3_new(fmin(node->min.x, instance->bounds_min.x), fmin(node->min.y, instance->bounds_min.y), fmin(node->min.z, instance->bounds_min.z));
+        node->max = vec3_new(fmax(node->max.x, instance->bounds_max.x), fmax(node->max.y, instance->bounds_max.y), fmax(node->max.z, instance->bounds_max.z));
+    }
+}
+
+static void fit_inner(bvh_node_t* node) {
+    bvh_node_t* left = &nodes[node->left];
+    bvh_node_t* right = &nodes[node->right];
+    node->min = vec3_new(fmin(left->min.x, right->min.x), fmin(left->min.y, right->min.y), fmin(left->min.z, right->min.z));
+    node->max = vec3_new(fmax(left->max.x, right->max.x), fmax(left->max.y, right->max.y), fmax(left->max.z, right->max.z));
+}
+
+static int build_node(int first_instance, int num_instances) {
+    bvh_node_t node = {.left = -1, .right = -1, .first_instance = first_instance, .num_instances = num_instances};
+    int node_index = array_length(nodes);
+    array_push(nodes, node);
+
+    if (num_instances <= BVH_LEAF_SIZE) {
+        fit_leaf(&nodes[node_index]);
+        return node_index;
+    }
+
+    // Split at the median instance center along the axis where the centers are spread the most
+    vec3_t min = get_instance_center(instance_order[first_instance]);
+    vec3_t max = min;
+    for (int i = first_instance + 1; i < first_instance + num_instances; i++) {
+        vec3_t center = get_instance_center(instance_order[i]);
+        min = vec3_new(fmin(min.x, center.x), fmin(min.y, center.y), fmin(min.z, center.z));
+        max = vec3_new(fmax(max.x, center.x), fmax(max.y, center.y), fmax(max.z, center.z));
+    }
+
+    vec3_t extent = vec3_sub(max, min);
+    sort_axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+    qsort(&instance_order[first_instance], num_instances, sizeof(int), compare_instance_centers);
+
+    int num_left = num_instances / 2;
+    int left = build_node(first_instance, num_left);
+    int right = build_node(first_instance + num_left, num_instances - num_left);
+
+    // Children are pushed after the parent, so look the parent up again in case the array moved
+    nodes[node_index].left = left;
+    nodes[node_index].right = right;
+    nodes[node_index].num_instances = 0;
+    fit_inner(&nodes[node_index]);
+
+    return node_index;
+}
+
+void build_instance_bvh(void) {
+    free_instance_bvh();
+
+    num_built_instances = get_num_instances();
+    if (num_built_instances == 0) {
+        return;
+    }
+
+    instance_order = (int*)malloc(sizeof(int) * num_built_instances);
+    for (int i = 0; i < num_built_instances; i++) {
+        instance_order[i] = i;
+    }
+
+    build_node(0, num_built_instances);
+}
+
+void refit_instance_bvh(void) {
+    // Children always come after their parent, so walking backwards updates children first
+    for (int i = array_length(nodes) - 1; i >= 0; i--) {
+        if (nodes[i].num_instances > 0) {
+            fit_leaf(&nodes[i]);
+        } else {
+            fit_inner(&nodes[i]);
+        }
+    }
+}
+
+void update_instance_bvh(bool has_moved) {
+    // Rebuild when instances were added and refit the existing tree when instances only moved
+    if (get_num_instances() != num_built_instances) {
+        build_instance_bvh();
+    } else if (has_moved) {
+        refit_instance_bvh();
+    }
+}
+
+static void collect_instances(int node_index, int* visible_instances, int* num_visible_instances) {
+    bvh_node_t* node = &nodes[node_index];
+
+    if (test_world_box_frustum(node->min, node->max) == FRUSTUM_OUTSIDE) {
+        return;
+    }
+
+    if (node->num_instances > 0) {
+        for (int i = node->first_instance; i < node->first_instance + node->num_instances; i++) {
+            visible_instances[(*num_visible_instances)++] = instance_order[i];
+        }
+        return;
+    }
+
+    collect_instances(node->left, visible_instances, num_visible_instances);
+    collect_instances(node->right, visible_instances, num_visible_instances);
+}
+
+int get_visible_instances(int* visible_instances) {
+    // Fill the array (with room for every instance) with the instances whose nodes touch the view frustum
+    int num_visible_instances = 0;
+
+    if (array_length(nodes) > 0) {
+        collect_instances(0, visible_instances, &num_visible_instances);
+    }
+
+    return num_visible_instances;
+}
+
+void free_instance_bvh(void) {
+    array_free(nodes);
+    nodes = NULL;
+    free(instance_order);
+    instance_order = NULL;
+    num_built_instances = 0;
+}
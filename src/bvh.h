@@ -0,0 +1,26 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <stdbool.h>
+#include "vector.h"
+
+// Maximum number of instances stored in a leaf node
+#define BVH_LEAF_SIZE 4
+
+typedef struct {
+    vec3_t min;             // bounding box minimum corner of everything below the node
+    vec3_t max;             // bounding box maximum corner of everything below the node
+    int left;               // index of the left child node (-1 for leaves)
+    int right;              // index of the right child node (-1 for leaves)
+    int first_instance;     // index of the first leaf instance in the instance order
+    int num_instances;      // number of instances in the leaf (0 for inner nodes)
+} bvh_node_t;
+
+void build_instance_bvh(void);
+void refit_instance_bvh(void);
+void update_instance_bvh(bool has_moved);
+int get_visible_instances(int* visible_instances);
+
+void free_instance_bvh(void);
+
+#endif
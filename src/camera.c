@@ -9,6 +9,7 @@ void init_camera(vec3_t position, vec3_t direction) {
     camera.sideways_velocity = vec3_new(0, 0, 0);
     camera.pitch = 0.0;
     camera.yaw = 0.0;
+    camera.is_dirty = true;
 }
 
 vec3_t get_camera_position(void) {
@@ -36,10 +37,16 @@ float get_camera_pitch(void) {
 }
 
 void update_camera_position(vec3_t position) {
+    if (position.x != camera.position.x || position.y != camera.position.y || position.z != camera.position.z) {
+        camera.is_dirty = true;
+    }
     camera.position = position;
 }
 
 void update_camera_direction(vec3_t direction) {
+    if (direction.x != camera.direction.x || direction.y != camera.direction.y || direction.z != camera.direction.z) {
+        camera.is_dirty = true;
+    }
     camera.direction = direction;
 }
 
@@ -52,10 +59,12 @@ void update_camera_sideways_velocity(vec3_t sideways_velocity) {
 }
 
 void update_camera_yaw(float yaw) {
+    if (yaw != 0) camera.is_dirty = true;
     camera.yaw += yaw;
 }
 
 void update_camera_pitch(float pitch) {
+    if (pitch != 0) camera.is_dirty = true;
     camera.pitch += pitch;
 }
 
@@ -79,4 +88,12 @@ vec3_t get_camera_look_at_target(void) {
     target = vec3_add(camera.position, camera.direction);
 
     return target;
-}
\ No newline at end of file
+}
+
+bool is_camera_dirty(void) {
+    return camera.is_dirty;
+}
+
+void clear_camera_dirty(void) {
+    camera.is_dirty = false;
+}
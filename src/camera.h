@@ -1,6 +1,7 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include <stdbool.h>
 #include "vector.h"
 #include "matrix.h"
 
@@ -11,6 +12,7 @@ typedef struct {
     vec3_t sideways_velocity;
     float pitch;
     float yaw;
+    bool is_dirty;      // position or orientation changed since the geometry was last processed
 } camera_t;
 
 void init_camera(vec3_t position, vec3_t direction);
@@ -31,4 +33,7 @@ void update_camera_pitch(float pitch);
 
 vec3_t get_camera_look_at_target(void);
 
+bool is_camera_dirty(void);
+void clear_camera_dirty(void);
+
 #endif
\ No newline at end of file
@@ -5,6 +5,9 @@
 #define NUM_PLANES 6
 plane_t frustum_planes[NUM_PLANES];
 
+// Frustum planes of the current frame moved to world space
+static plane_t world_frustum_planes[NUM_PLANES];
+
 void init_frustum_planes(float fov_x, float fov_y, float z_near, float z_far) {
 	float cos_half_fov_x = cos(fov_x / 2);
 	float sin_half_fov_x = sin(fov_x / 2);
@@ -42,7 +45,7 @@ void init_frustum_planes(float fov_x, float fov_y, float z_near, float z_far) {
 	frustum_planes[FAR_FRUSTUM_PLANE].normal.z = -1;
 }
 
-polygon_t polygon_from_triangle(vec3_t v0, vec3_t v1, vec3_t v2, tex2_t t0, tex2_t t1, tex2_t t2) {
+polygon_t polygon_from_triangle(vec4_t v0, vec4_t v1, vec4_t v2, tex2_t t0, tex2_t t1, tex2_t t2) {
     polygon_t result = {
         .vertices = {v0, v1, v2},
         .tex_coords = {t0, t1, t2},
@@ -59,9 +62,9 @@ void triangles_from_polygon(polygon_t* polygon, triangle_t triangles[], int* num
         int index2 = i + 2;
 
         // Load vertices
-        triangles[i].points[0] = vec4_from_vec3(polygon->vertices[index0]);
-        triangles[i].points[1] = vec4_from_vec3(polygon->vertices[index1]);
-        triangles[i].points[2] = vec4_from_vec3(polygon->vertices[index2]);
+        triangles[i].points[0] = polygon->vertices[index0];
+        triangles[i].points[1] = polygon->vertices[index1];
+        triangles[i].points[2] = polygon->vertices[index2];
 
         // Load texture coordinates
         triangles[i].tex_coords[0] = polygon->tex_coords[index0];
@@ -76,31 +79,45 @@ float float_lerp(float a, float b, float t) {
     return a + t * (b - a);
 }
 
+float get_clip_distance(vec4_t vertex, int plane) {
+    // Clip space is inside where -w <= x <= w, -w <= y <= w and 0 <= z <= w
+    switch (plane) {
+        case LEFT_FRUSTUM_PLANE: return vertex.w + vertex.x;
+        case RIGHT_FRUSTUM_PLANE: return vertex.w - vertex.x;
+        case TOP_FRUSTUM_PLANE: return vertex.w - vertex.y;
+        case BOTTOM_FRUSTUM_PLANE: return vertex.w + vertex.y;
+        case NEAR_FRUSTUM_PLANE: return vertex.z;
+        default: return vertex.w - vertex.z;
+    }
+}
+
 void clip_polygon_against_plane(polygon_t* polygon, int plane) {
-    vec3_t plane_point = frustum_planes[plane].point;
-    vec3_t plane_normal = frustum_planes[plane].normal;
+    // Nothing left to clip if a previous plane removed the whole polygon
+    if (polygon->num_vertices == 0) {
+        return;
+    }
 
     // Declare an array of vertices inside the plane which will assigned to the polygon at the end
-    vec3_t inside_vertices[MAX_NUM_POLY_VERTICES];
+    vec4_t inside_vertices[MAX_NUM_POLY_VERTICES];
     tex2_t inside_tex_coords[MAX_NUM_POLY_VERTICES];
     int num_inside_vertices = 0;
 
     // initialize current vertex with first polygon vertex and texture coordinate
-    vec3_t* current_vertex = &polygon->vertices[0];
+    vec4_t* current_vertex = &polygon->vertices[0];
     tex2_t* current_tex_coord = &polygon->tex_coords[0];
 
 
     // initialize previous vertex with last polygon vertex and texture coordinate
-    vec3_t* previous_vertex = &polygon->vertices[polygon->num_vertices - 1];
+    vec4_t* previous_vertex = &polygon->vertices[polygon->num_vertices - 1];
     tex2_t* previous_tex_coord = &polygon->tex_coords[polygon->num_vertices - 1];
 
-    // initialize current and previous dot products 
+    // initialize current and previous distances to the plane
     float current_dot = 0;
-    float previous_dot = vec3_dot(vec3_sub(*previous_vertex, plane_point), plane_normal);
+    float previous_dot = get_clip_distance(*previous_vertex, plane);
 
     // Loop through all polygon vertices to find vertices within the plane
     while (current_vertex != &polygon->vertices[polygon->num_vertices]) {
-        current_dot = vec3_dot(vec3_sub(*current_vertex, plane_point), plane_normal);
+        current_dot = get_clip_distance(*current_vertex, plane);
 
         // Check if vertex changes from being inside to outside the plane or vice versa
         if (current_dot * previous_dot < 0) {
@@ -108,11 +125,12 @@ void clip_polygon_against_plane(polygon_t* polygon, int plane) {
             float t = previous_dot / (previous_dot - current_dot);
 
             // Calculate intersection point using lerp formula
-            vec3_t intersection_point = {
+            vec4_t intersection_point = {
                 .x = float_lerp(previous_vertex->x, current_vertex->x, t),
                 .y = float_lerp(previous_vertex->y, current_vertex->y, t),
-                .z = float_lerp(previous_vertex->z, current_vertex->z, t)
-            }; 
+                .z = float_lerp(previous_vertex->z, current_vertex->z, t),
+                .w = float_lerp(previous_vertex->w, current_vertex->w, t)
+            };
 
             // Calculate U and V texture coordinate using lerp formula
             tex2_t interpolated_tex_coord = {
@@ -155,4 +173,127 @@ void clip_polygon(polygon_t* polygon) {
     clip_polygon_against_plane(polygon, BOTTOM_FRUSTUM_PLANE);
     clip_polygon_against_plane(polygon, NEAR_FRUSTUM_PLANE);
     clip_polygon_against_plane(polygon, FAR_FRUSTUM_PLANE);
+}
+
+int get_vertex_outcode(vec4_t vertex) {
+    int outcode = 0;
+
+    // Vertices on a plane count as outside, the same as in clip_polygon_against_plane
+    for (int plane = 0; plane < NUM_PLANES; plane++) {
+        if (get_clip_distance(vertex, plane) <= 0) {
+            outcode |= FRUSTUM_OUTCODE(plane);
+        }
+    }
+
+    // The guard band reaches GUARD_BAND_SCALE times further out than the side planes
+    float guard_w = vertex.w * GUARD_BAND_SCALE;
+    if (guard_w + vertex.x <= 0) outcode |= GUARD_BAND_OUTCODE(LEFT_FRUSTUM_PLANE);
+    if (guard_w - vertex.x <= 0) outcode |= GUARD_BAND_OUTCODE(RIGHT_FRUSTUM_PLANE);
+    if (guard_w - vertex.y <= 0) outcode |= GUARD_BAND_OUTCODE(TOP_FRUSTUM_PLANE);
+    if (guard_w + vertex.y <= 0) outcode |= GUARD_BAND_OUTCODE(BOTTOM_FRUSTUM_PLANE);
+
+    return outcode;
+}
+
+void clip_polygon_with_outcodes(polygon_t* polygon, int outcode_union) {
+    // Near and far planes are always clipped, side planes only if a vertex is outside the guard band
+    int planes_to_clip = outcode_union & NEAR_FAR_OUTCODES;
+    if (outcode_union & GUARD_BAND_OUTCODES) {
+        planes_to_clip |= outcode_union & SIDE_OUTCODES;
+    }
+
+    for (int plane = 0; plane < NUM_PLANES; plane++) {
+        if (planes_to_clip & FRUSTUM_OUTCODE(plane)) {
+            clip_polygon_against_plane(polygon, plane);
+        }
+    }
+}
+
+int test_sphere_frustum(vec3_t center, float radius) {
+    int result = FRUSTUM_INSIDE;
+
+    for (int plane = 0; plane < NUM_PLANES; plane++) {
+        float distance = vec3_dot(vec3_sub(center, frustum_planes[plane].point), frustum_planes[plane].normal);
+
+        // Sphere is outside if it lies completely behind any of the frustum planes
+        if (distance < -radius) {
+            return FRUSTUM_OUTSIDE;
+        }
+        // Sphere is only inside if it lies completely in front of all of them
+        if (distance <= radius) {
+            result = FRUSTUM_INTERSECTING;
+        }
+    }
+
+    return result;
+}
+
+void update_world_frustum_planes(mat4_t view_matrix) {
+    // The view matrix only rotates and translates, so its inverse is the transposed rotation
+    // applied after undoing the translation
+    vec3_t translation = vec3_new(view_matrix.m[0][3], view_matrix.m[1][3], view_matrix.m[2][3]);
+
+    for (int plane = 0; plane < NUM_PLANES; plane++) {
+        vec3_t normal = frustum_planes[plane].normal;
+        vec3_t point = vec3_sub(frustum_planes[plane].point, translation);
+
+        world_frustum_planes[plane].normal = vec3_new(
+            view_matrix.m[0][0] * normal.x + view_matrix.m[1][0] * normal.y + view_matrix.m[2][0] * normal.z,
+            view_matrix.m[0][1] * normal.x + view_matrix.m[1][1] * normal.y + view_matrix.m[2][1] * normal.z,
+            view_matrix.m[0][2] * normal.x + view_matrix.m[1][2] * normal.y + view_matrix.m[2][2] * normal.z
+        );
+        world_frustum_planes[plane].point = vec3_new(
+            view_matrix.m[0][0] * point.x + view_matrix.m[1][0] * point.y + view_matrix.m[2][0] * point.z,
+            view_matrix.m[0][1] * point.x + view_matrix.m[1][1] * point.y + view_matrix.m[2][1] * point.z,
+            view_matrix.m[0][2] * point.x + view_matrix.m[1][2] * point.y + view_matrix.m[2][2] * point.z
+        );
+    }
+}
+
+int test_world_box_frustum(vec3_t min, vec3_t max) {
+    int result = FRUSTUM_INSIDE;
+
+    for (int plane = 0; plane < NUM_PLANES; plane++) {
+        vec3_t normal = world_frustum_planes[plane].normal;
+        vec3_t point = world_frustum_planes[plane].point;
+
+        // Corners of the box furthest along and furthest against the plane normal
+        vec3_t positive = vec3_new(normal.x >= 0 ? max.x : min.x, normal.y >= 0 ? max.y : min.y, normal.z >= 0 ? max.z : min.z);
+        vec3_t negative = vec3_new(normal.x >= 0 ? min.x : max.x, normal.y >= 0 ? min.y : max.y, normal.z >= 0 ? min.z : max.z);
+
+        if (vec3_dot(vec3_sub(positive, point), normal) < 0) {
+            return FRUSTUM_OUTSIDE;
+        }
+        if (vec3_dot(vec3_sub(negative, point), normal) <= 0) {
+            result = FRUSTUM_INTERSECTING;
+        }
+    }
+
+    return result;
+}
+
+int test_box_frustum(vec3_t corners[8]) {
+    int result = FRUSTUM_INSIDE;
+
+    for (int plane = 0; plane < NUM_PLANES; plane++) {
+        int num_inside_corners = 0;
+
+        for (int i = 0; i < 8; i++) {
+            float distance = vec3_dot(vec3_sub(corners[i], frustum_planes[plane].point), frustum_planes[plane].normal);
+
+            if (distance > 0) {
+                num_inside_corners++;
+            }
+        }
+
+        // Box is outside if all corners are behind the same plane
+        if (num_inside_corners == 0) {
+            return FRUSTUM_OUTSIDE;
+        }
+        if (num_inside_corners < 8) {
+            result = FRUSTUM_INTERSECTING;
+        }
+    }
+
+    return result;
 }
\ No newline at end of file
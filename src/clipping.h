@@ -1,12 +1,17 @@
 #ifndef CLIPPING_H
 #define CLIPPING_H
 
+#include <stdbool.h>
 #include "vector.h"
 #include "triangle.h"
+#include "matrix.h"
 
 #define MAX_NUM_POLY_VERTICES 10
 #define MAX_NUM_POLY_TRIANGLES 10
 
+// Side planes of the guard band are this many times further out than the frustum side planes in clip space
+#define GUARD_BAND_SCALE 2.0
+
 enum {
     LEFT_FRUSTUM_PLANE,
     RIGHT_FRUSTUM_PLANE,
@@ -16,21 +21,44 @@ enum {
     FAR_FRUSTUM_PLANE
 };
 
+// Outcode bits of vertices outside each frustum plane, and outside each side plane of the guard band
+#define FRUSTUM_OUTCODE(plane) (1 << (plane))
+#define GUARD_BAND_OUTCODE(plane) (1 << (6 + (plane)))
+#define SIDE_OUTCODES 0x0F
+#define NEAR_FAR_OUTCODES 0x30
+#define FRUSTUM_OUTCODES 0x3F
+#define GUARD_BAND_OUTCODES 0x3C0
+
+enum {
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECTING,
+    FRUSTUM_INSIDE
+};
+
 typedef struct {
     vec3_t point;
     vec3_t normal;
 } plane_t;
 
 
+// Polygon with vertices in homogeneous clip space
 typedef struct {
-    vec3_t vertices[MAX_NUM_POLY_VERTICES];
+    vec4_t vertices[MAX_NUM_POLY_VERTICES];
     tex2_t tex_coords[MAX_NUM_POLY_VERTICES];
     int num_vertices;
 } polygon_t;
 
 void init_frustum_planes(float fov_x, float fov_y, float z_near, float z_far);
-polygon_t polygon_from_triangle(vec3_t v0, vec3_t v1, vec3_t v2, tex2_t t0, tex2_t t1, tex2_t t2);
+polygon_t polygon_from_triangle(vec4_t v0, vec4_t v1, vec4_t v2, tex2_t t0, tex2_t t1, tex2_t t2);
 void triangles_from_polygon(polygon_t* polygon, triangle_t triangles[], int* num_triangles);
+float get_clip_distance(vec4_t vertex, int plane);
+void clip_polygon_against_plane(polygon_t* polygon, int plane);
 void clip_polygon(polygon_t* polygon);
+int get_vertex_outcode(vec4_t vertex);
+void clip_polygon_with_outcodes(polygon_t* polygon, int outcode_union);
+int test_sphere_frustum(vec3_t center, float radius);
+int test_box_frustum(vec3_t corners[8]);
+void update_world_frustum_planes(mat4_t view_matrix);
+int test_world_box_frustum(vec3_t min, vec3_t max);
 
 #endif
\ No newline at end of file
@@ -1,19 +1,145 @@
 #include "display.h"
+#include <math.h>
+#include "image.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DISPLAY_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define DISPLAY_NEON
+#endif
 
 static SDL_Window* window = NULL;
 static SDL_Renderer* renderer = NULL;
 
+typedef struct {
+    uint32_t* pixels;
+    screen_rect_t dirty_rect;  // region that changed since the buffer was last drawn
+    screen_rect_t upload_rect; // region drawn into the buffer that the texture does not have yet
+} color_buffer_t;
+
+// Frames are drawn into the back buffer while the front buffer is presented
+static color_buffer_t color_buffers[NUM_COLOR_BUFFERS];
+static int back_buffer = 0;
+static int front_buffer = NUM_COLOR_BUFFERS - 1;
+
 static uint32_t* color_buffer = NULL;
-static float* z_buffer = NULL;
 static SDL_Texture* color_buffer_texture = NULL;
 
+// Depth per pixel as 32 or 16-bit integers that keep the order of the depths they were converted from
+static void* z_buffer = NULL;
+static int depth_format = DEPTH_FORMAT_FLOAT32;
+static uint32_t cleared_depth_value = 0;
+
+// Depth range of visible geometry, mapped to the full integer range of the fixed-point formats
+static float depth_range_min = 0;
+static float depth_range_scale = 1;
+
+// Frame epoch each depth value was written in, depths from older epochs read as cleared.
+// The 24-bit format keeps the epoch in the top byte of the depth value instead
+static uint8_t* z_epochs = NULL;
+static uint8_t z_epoch = 0;
+static int depth_clear_method = DEPTH_CLEAR_FULL;
+
 static int window_width = 480;
 static int window_height = 360;
+static bool is_window_size_set = false;
+
+// Pixels stored per buffer, the window size rounded up to whole tiles so either layout fits
+static int num_buffer_pixels = 0;
+static int tiles_per_row = 0;
+static int framebuffer_layout = FRAMEBUFFER_LINEAR;
+
+// Linear copy of the presented frame for writing it to a file
+static uint32_t* resolve_buffer = NULL;
 
 static int render_method = 0;
 static int cull_method = 0;
 
-bool initalize_window(void) {
+static int display_backend = DISPLAY_SDL;
+
+// Presented frames are written to <frame_output_path>_<frame number>.<extension> if a path is set
+static const char* frame_output_path = NULL;
+static int frame_output_format = IMAGE_PPM;
+static int num_output_frames = 0;
+
+static void fill_u32(uint32_t* values, uint32_t value, int count) {
+    int i = 0;
+
+#if defined(DISPLAY_SSE2)
+    __m128i values_4 = _mm_set1_epi32((int)value);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)&values[i], values_4);
+    }
+#elif defined(DISPLAY_NEON)
+    uint32x4_t values_4 = vdupq_n_u32(value);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u32(&values[i], values_4);
+    }
+#endif
+
+    for (; i < count; i++) {
+        values[i] = value;
+    }
+}
+
+static void fill_u16(uint16_t* values, uint16_t value, int count) {
+    int i = 0;
+
+#if defined(DISPLAY_SSE2)
+    __m128i values_8 = _mm_set1_epi16((short)value);
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128((__m128i*)&values[i], values_8);
+    }
+#elif defined(DISPLAY_NEON)
+    uint16x8_t values_8 = vdupq_n_u16(value);
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u16(&values[i], values_8);
+    }
+#endif
+
+    for (; i < count; i++) {
+        values[i] = value;
+    }
+}
+
+static int get_pixel_index(int x, int y) {
+    // Tiles are stored one after another in rows of tiles, each tile holding its pixels row by row
+    if (framebuffer_layout == FRAMEBUFFER_TILED) {
+        int tile = (y >> FRAMEBUFFER_TILE_SHIFT) * tiles_per_row + (x >> FRAMEBUFFER_TILE_SHIFT);
+        int tile_y = y & (FRAMEBUFFER_TILE_SIZE - 1);
+        int tile_x = x & (FRAMEBUFFER_TILE_SIZE - 1);
+        return (tile << (2 * FRAMEBUFFER_TILE_SHIFT)) + (tile_y << FRAMEBUFFER_TILE_SHIFT) + tile_x;
+    }
+
+    return (y * window_width) + x;
+}
+
+static int get_contiguous_pixels(int x, int max_x) {
+    // Number of pixels from x towards max_x on the same row that sit next to each other in memory
+    if (framebuffer_layout == FRAMEBUFFER_TILED) {
+        int tile_end = (x | (FRAMEBUFFER_TILE_SIZE - 1)) + 1;
+        return (tile_end < max_x ? tile_end : max_x) - x;
+    }
+
+    return max_x - x;
+}
+
+static void resolve_color_buffer(uint32_t* pixels, screen_rect_t rect, uint32_t* destination, int destination_pitch) {
+    // Copy a region of a buffer into a linear image with rows destination_pitch pixels apart
+    for (int y = rect.min_y; y < rect.max_y; y++) {
+        uint32_t* row = &destination[(y - rect.min_y) * destination_pitch];
+
+        for (int x = rect.min_x; x < rect.max_x;) {
+            int count = get_contiguous_pixels(x, rect.max_x);
+            memcpy(&row[x - rect.min_x], &pixels[get_pixel_index(x, y)], count * sizeof(uint32_t));
+            x += count;
+        }
+    }
+}
+
+static bool initalize_sdl_window(void) {
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
         fprintf(stderr, "Error initalizing SDL.\n");
         return false;
@@ -26,9 +152,11 @@ bool initalize_window(void) {
     int fullscreen_width = display_mode.w;
     int fullscreen_height = display_mode.h;
 
-    // Change resolution to get pixelated effect
-    window_width = fullscreen_width / 1;
-    window_height = fullscreen_height / 1;
+    // Change resolution to get pixelated effect, unless a resolution was requested
+    if (!is_window_size_set) {
+        window_width = fullscreen_width / 1;
+        window_height = fullscreen_height / 1;
+    }
 
     // Create a SDL window
     window = SDL_CreateWindow(
@@ -59,10 +187,6 @@ bool initalize_window(void) {
     // Hide mouse and lock it to center of screen
     SDL_SetRelativeMouseMode(SDL_TRUE);
 
-    // Allocate required memory to hold color buffer and z buffer
-    color_buffer = (uint32_t*) malloc(sizeof(uint32_t) * window_width * window_height);
-    z_buffer = (float*) malloc(sizeof(float) * window_width * window_height);
-
     // Create SDL texture that will display color buffer
     color_buffer_texture = SDL_CreateTexture(
         renderer,
@@ -75,6 +199,75 @@ bool initalize_window(void) {
     return true;
 }
 
+static bool initalize_headless_window(void) {
+    // Without a window only timers and the (empty) event queue are needed
+    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0) {
+        fprintf(stderr, "Error initalizing SDL.\n");
+        return false;
+    }
+
+    return true;
+}
+
+bool initalize_window(void) {
+    bool is_initalized = display_backend == DISPLAY_HEADLESS ? initalize_headless_window() : initalize_sdl_window();
+
+    if (!is_initalized) {
+        return false;
+    }
+
+    tiles_per_row = (window_width + FRAMEBUFFER_TILE_SIZE - 1) / FRAMEBUFFER_TILE_SIZE;
+    int tiles_per_column = (window_height + FRAMEBUFFER_TILE_SIZE - 1) / FRAMEBUFFER_TILE_SIZE;
+    num_buffer_pixels = tiles_per_row * tiles_per_column * FRAMEBUFFER_TILE_SIZE * FRAMEBUFFER_TILE_SIZE;
+
+    // Allocate required memory to hold color buffers and z buffer, only the drawing thread uses the z buffer
+    screen_rect_t screen = {0, 0, window_width, window_height};
+    for (int i = 0; i < NUM_COLOR_BUFFERS; i++) {
+        color_buffers[i].pixels = (uint32_t*) malloc(sizeof(uint32_t) * num_buffer_pixels);
+        color_buffers[i].upload_rect = screen;
+        fill_u32(color_buffers[i].pixels, 0xFF000000, num_buffer_pixels);
+    }
+    color_buffer = color_buffers[back_buffer].pixels;
+    z_epochs = (uint8_t*) calloc(num_buffer_pixels, sizeof(uint8_t));
+    set_depth_format(depth_format);
+
+    if (display_backend == DISPLAY_HEADLESS) {
+        resolve_buffer = (uint32_t*) malloc(sizeof(uint32_t) * window_width * window_height);
+    }
+
+    // The first frame draws the whole screen
+    invalidate_screen();
+
+    return true;
+}
+
+void set_display_backend(int backend) {
+    display_backend = backend;
+}
+
+bool is_display_headless(void) {
+    return display_backend == DISPLAY_HEADLESS;
+}
+
+void set_window_size(int width, int height) {
+    window_width = width;
+    window_height = height;
+    is_window_size_set = true;
+}
+
+void set_framebuffer_layout(int layout) {
+    // Pixels already in the buffers are at the wrong places for the new layout
+    if (layout != framebuffer_layout) {
+        invalidate_screen();
+    }
+    framebuffer_layout = layout;
+}
+
+void set_frame_output(const char* path, int format) {
+    frame_output_path = path;
+    frame_output_format = format;
+}
+
 int get_window_width(void) {
     return window_width;
 }
@@ -84,6 +277,10 @@ int get_window_height(void) {
 }
 
 void set_render_method(int method) {
+    // Every pixel is drawn differently, so the whole screen has to be redrawn
+    if (method != render_method) {
+        invalidate_screen();
+    }
     render_method = method;
 }
 
@@ -95,6 +292,76 @@ bool is_cull_backface(void) {
     return cull_method == CULL_BACKFACE;
 }
 
+void set_depth_clear_method(int method) {
+    depth_clear_method = method;
+}
+
+static uint32_t quantize_depth(float depth, uint32_t max_value) {
+    float unorm = (depth - depth_range_min) * depth_range_scale;
+
+    if (unorm <= 0) return 0;
+    if (unorm >= 1) return max_value;
+    return (uint32_t)(unorm * max_value + 0.5f);
+}
+
+uint32_t get_depth_value(float depth) {
+    // Degenerate triangles interpolate NaN depths, which must never pass the depth test
+    if (isnan(depth)) {
+        return UINT32_MAX;
+    }
+
+    switch (depth_format) {
+        case DEPTH_FORMAT_UNORM16:
+            return quantize_depth(depth, DEPTH_UNORM16_MAX);
+        case DEPTH_FORMAT_UNORM24:
+            return quantize_depth(depth, DEPTH_UNORM24_MAX);
+        default: {
+            // Flip negative floats entirely and positive ones only in the sign bit so unsigned order matches float order
+            uint32_t bits;
+            memcpy(&bits, &depth, sizeof(bits));
+            return (bits & 0x80000000) ? ~bits : bits | 0x80000000;
+        }
+    }
+}
+
+void set_depth_range(float z_near, float z_far) {
+    // Depth is stored as 1 - 1/w, clipping keeps w between the near and far planes
+    float min_depth = 1 - 1 / z_near;
+    float max_depth = 1 - 1 / z_far;
+
+    depth_range_min = min_depth;
+    depth_range_scale = 1 / (max_depth - min_depth);
+    cleared_depth_value = get_depth_value(1.0);
+    invalidate_screen();
+}
+
+void set_depth_format(int format) {
+    int num_pixels = num_buffer_pixels;
+    int depth_size = format == DEPTH_FORMAT_UNORM16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    depth_format = format;
+    cleared_depth_value = get_depth_value(1.0);
+
+    // Before the window exists only the format is remembered
+    if (!z_epochs) {
+        return;
+    }
+
+    // Start the new buffer cleared with every epoch expired
+    free(z_buffer);
+    z_buffer = malloc(depth_size * num_pixels);
+    memset(z_epochs, 0, num_pixels);
+    z_epoch = 0;
+
+    if (format == DEPTH_FORMAT_UNORM16) {
+        fill_u16((uint16_t*)z_buffer, cleared_depth_value, num_pixels);
+    } else {
+        fill_u32((uint32_t*)z_buffer, cleared_depth_value, num_pixels);
+    }
+
+    invalidate_screen();
+}
+
 bool should_render_filled_triangles(void) {
     return (
         render_method == RENDER_FILL_TRIANGLE || 
@@ -123,11 +390,12 @@ bool should_render_vertices(void) {
 }
 
 void draw_pixel(int x, int y, uint32_t color) {
-    if (x < 0 || x >= window_width || y < 0 || y >= window_height) {
+    screen_rect_t dirty_rect = color_buffers[back_buffer].dirty_rect;
+    if (x < dirty_rect.min_x || x >= dirty_rect.max_x || y < dirty_rect.min_y || y >= dirty_rect.max_y) {
         return;
     }
 
-    color_buffer[(y * window_width) + x] = color;
+    color_buffer[get_pixel_index(x, y)] = color;
 }
 
 void draw_line(int x0, int y0, int x1, int y1, uint32_t color) {
@@ -167,9 +435,15 @@ void draw_line(int x0, int y0, int x1, int y1, uint32_t color) {
 }
 
 void draw_grid(void) {
-    for (int y = 0; y < window_height; y += 10) {
-        for (int x = 0; x < window_width; x += 10) {
-            color_buffer[(window_width * y) + x] = 0xFF444444;
+    screen_rect_t dirty_rect = color_buffers[back_buffer].dirty_rect;
+
+    // Start at the first grid line inside the redrawn region
+    int first_x = (dirty_rect.min_x + 9) / 10 * 10;
+    int first_y = (dirty_rect.min_y + 9) / 10 * 10;
+
+    for (int y = first_y; y < dirty_rect.max_y; y += 10) {
+        for (int x = first_x; x < dirty_rect.max_x; x += 10) {
+            color_buffer[get_pixel_index(x, y)] = 0xFF444444;
         }
     }
 }
@@ -182,14 +456,125 @@ void draw_rect(int x, int y, int width, int height, uint32_t color) {
     }
 }
 
-void render_color_buffer(void) {
-    SDL_UpdateTexture(
-        color_buffer_texture,
-        NULL,
-        color_buffer,
-        (int) (window_width * sizeof(uint32_t))
+screen_rect_t get_empty_screen_rect(void) {
+    screen_rect_t rect = {0, 0, 0, 0};
+    return rect;
+}
+
+screen_rect_t get_screen_rect_union(screen_rect_t a, screen_rect_t b) {
+    if (is_screen_rect_empty(a)) return b;
+    if (is_screen_rect_empty(b)) return a;
+
+    screen_rect_t rect = {
+        a.min_x < b.min_x ? a.min_x : b.min_x,
+        a.min_y < b.min_y ? a.min_y : b.min_y,
+        a.max_x > b.max_x ? a.max_x : b.max_x,
+        a.max_y > b.max_y ? a.max_y : b.max_y
+    };
+    return rect;
+}
+
+bool is_screen_rect_empty(screen_rect_t rect) {
+    return rect.min_x >= rect.max_x || rect.min_y >= rect.max_y;
+}
+
+bool are_screen_rects_equal(screen_rect_t a, screen_rect_t b) {
+    if (is_screen_rect_empty(a) && is_screen_rect_empty(b)) return true;
+    return a.min_x == b.min_x && a.min_y == b.min_y && a.max_x == b.max_x && a.max_y == b.max_y;
+}
+
+void invalidate_screen(void) {
+    screen_rect_t screen = {0, 0, window_width, window_height};
+    for (int i = 0; i < NUM_COLOR_BUFFERS; i++) {
+        color_buffers[i].dirty_rect = screen;
+    }
+}
+
+void invalidate_screen_rect(screen_rect_t rect) {
+    // Keep the dirty region inside the screen
+    if (rect.min_x < 0) rect.min_x = 0;
+    if (rect.min_y < 0) rect.min_y = 0;
+    if (rect.max_x > window_width) rect.max_x = window_width;
+    if (rect.max_y > window_height) rect.max_y = window_height;
+
+    // Every buffer missed the change, including those still holding older frames
+    if (!is_screen_rect_empty(rect)) {
+        for (int i = 0; i < NUM_COLOR_BUFFERS; i++) {
+            color_buffers[i].dirty_rect = get_screen_rect_union(color_buffers[i].dirty_rect, rect);
+        }
+    }
+}
+
+screen_rect_t get_dirty_rect(void) {
+    return color_buffers[back_buffer].dirty_rect;
+}
+
+bool is_screen_dirty(void) {
+    return !is_screen_rect_empty(color_buffers[back_buffer].dirty_rect);
+}
+
+void swap_color_buffers(void) {
+    // The finished back buffer becomes the one presented next
+    color_buffer_t* finished = &color_buffers[back_buffer];
+    finished->upload_rect = finished->dirty_rect;
+    finished->dirty_rect = get_empty_screen_rect();
+
+    front_buffer = back_buffer;
+    back_buffer = (back_buffer + 1) % NUM_COLOR_BUFFERS;
+    color_buffer = color_buffers[back_buffer].pixels;
+}
+
+static void write_color_buffer(void) {
+    char filename[1024];
+    snprintf(
+        filename,
+        sizeof(filename),
+        "%s_%04d.%s",
+        frame_output_path,
+        ++num_output_frames,
+        get_image_extension(frame_output_format)
     );
 
+    // Bring the frame into row-major order before writing it
+    screen_rect_t screen = {0, 0, window_width, window_height};
+    resolve_color_buffer(color_buffers[front_buffer].pixels, screen, resolve_buffer, window_width);
+
+    write_image(filename, frame_output_format, resolve_buffer, window_width, window_height);
+}
+
+void render_color_buffer(void) {
+    // Without a window the finished frame is only written out
+    if (display_backend == DISPLAY_HEADLESS) {
+        if (frame_output_path) {
+            write_color_buffer();
+        }
+        color_buffers[front_buffer].upload_rect = get_empty_screen_rect();
+        return;
+    }
+
+    // Upload only the region that was redrawn, the texture keeps the rest from earlier frames
+    color_buffer_t* front = &color_buffers[front_buffer];
+    screen_rect_t upload_rect = front->upload_rect;
+
+    if (!is_screen_rect_empty(upload_rect)) {
+        SDL_Rect rect = {
+            upload_rect.min_x,
+            upload_rect.min_y,
+            upload_rect.max_x - upload_rect.min_x,
+            upload_rect.max_y - upload_rect.min_y
+        };
+
+        // Resolve the region straight into the streaming texture, linearizing tiles on the way
+        void* texture_pixels;
+        int texture_pitch;
+        if (SDL_LockTexture(color_buffer_texture, &rect, &texture_pixels, &texture_pitch) == 0) {
+            resolve_color_buffer(front->pixels, upload_rect, (uint32_t*)texture_pixels, texture_pitch / sizeof(uint32_t));
+            SDL_UnlockTexture(color_buffer_texture);
+        }
+
+        front->upload_rect = get_empty_screen_rect();
+    }
+
     SDL_RenderCopy(
         renderer,
         color_buffer_texture,
@@ -201,38 +586,122 @@ void render_color_buffer(void) {
 }
 
 void clear_color_buffer(uint32_t color) {
-    for (int i = 0; i < window_width * window_height; i++) {
-        color_buffer[i] = color;
+    screen_rect_t dirty_rect = color_buffers[back_buffer].dirty_rect;
+    if (is_screen_rect_empty(dirty_rect)) {
+        return;
+    }
+
+    // Linear rows spanning the whole width are contiguous and are filled in one go
+    if (framebuffer_layout == FRAMEBUFFER_LINEAR && dirty_rect.min_x == 0 && dirty_rect.max_x == window_width) {
+        int count = window_width * (dirty_rect.max_y - dirty_rect.min_y);
+        fill_u32(&color_buffer[dirty_rect.min_y * window_width], color, count);
+        return;
+    }
+
+    for (int y = dirty_rect.min_y; y < dirty_rect.max_y; y++) {
+        for (int x = dirty_rect.min_x; x < dirty_rect.max_x;) {
+            int count = get_contiguous_pixels(x, dirty_rect.max_x);
+            fill_u32(&color_buffer[get_pixel_index(x, y)], color, count);
+            x += count;
+        }
     }
 }
 
 void clear_z_buffer(void) {
-    for (int i = 0; i < window_width * window_height; i++) {
-        z_buffer[i] = 1.0;
+    int num_pixels = num_buffer_pixels;
+
+    // Start a new epoch instead of writing every depth, only wrapping around needs the epochs reset
+    if (depth_clear_method == DEPTH_CLEAR_EPOCH) {
+        z_epoch++;
+        if (z_epoch == 0) {
+            if (depth_format == DEPTH_FORMAT_UNORM24) {
+                fill_u32((uint32_t*)z_buffer, cleared_depth_value, num_pixels);
+            } else {
+                memset(z_epochs, 0, num_pixels);
+            }
+            z_epoch = 1;
+        }
+        return;
+    }
+
+    screen_rect_t dirty_rect = color_buffers[back_buffer].dirty_rect;
+    if (is_screen_rect_empty(dirty_rect)) {
+        return;
+    }
+
+    for (int y = dirty_rect.min_y; y < dirty_rect.max_y; y++) {
+        for (int x = dirty_rect.min_x; x < dirty_rect.max_x;) {
+            int index = get_pixel_index(x, y);
+            int count = get_contiguous_pixels(x, dirty_rect.max_x);
+
+            if (depth_format == DEPTH_FORMAT_UNORM16) {
+                fill_u16(&((uint16_t*)z_buffer)[index], cleared_depth_value, count);
+            } else {
+                fill_u32(&((uint32_t*)z_buffer)[index], cleared_depth_value, count);
+            }
+            x += count;
+        }
     }
 }
 
-float get_z_buffer_at(int x, int y) {
+uint32_t get_z_buffer_at(int x, int y) {
     if (x < 0 || x >= window_width || y < 0 || y >= window_height) {
-        return 1.0;
+        return cleared_depth_value;
     }
 
-    return z_buffer[(y * window_width) + x];
+    int index = get_pixel_index(x, y);
+    bool is_epoch_clear = depth_clear_method == DEPTH_CLEAR_EPOCH;
+
+    switch (depth_format) {
+        case DEPTH_FORMAT_UNORM16:
+            if (is_epoch_clear && z_epochs[index] != z_epoch) return cleared_depth_value;
+            return ((uint16_t*)z_buffer)[index];
+        case DEPTH_FORMAT_UNORM24: {
+            uint32_t value = ((uint32_t*)z_buffer)[index];
+            if (is_epoch_clear && (value >> 24) != z_epoch) return cleared_depth_value;
+            return value & DEPTH_UNORM24_MAX;
+        }
+        default:
+            if (is_epoch_clear && z_epochs[index] != z_epoch) return cleared_depth_value;
+            return ((uint32_t*)z_buffer)[index];
+    }
 }
 
-void update_z_buffer_at(int x, int y, float value) {
+void update_z_buffer_at(int x, int y, uint32_t value) {
     if (x < 0 || x >= window_width || y < 0 || y >= window_height) {
         return;
     }
 
-    z_buffer[(y * window_width) + x] = value;
+    // Tag the depth in either clear method so switching to epochs never sees stale values as current
+    int index = get_pixel_index(x, y);
+
+    switch (depth_format) {
+        case DEPTH_FORMAT_UNORM16:
+            ((uint16_t*)z_buffer)[index] = value;
+            z_epochs[index] = z_epoch;
+            break;
+        case DEPTH_FORMAT_UNORM24:
+            ((uint32_t*)z_buffer)[index] = ((uint32_t)z_epoch << 24) | value;
+            break;
+        default:
+            ((uint32_t*)z_buffer)[index] = value;
+            z_epochs[index] = z_epoch;
+            break;
+    }
 }
 
 void destroy_window(void) {
-    free(color_buffer);
+    for (int i = 0; i < NUM_COLOR_BUFFERS; i++) {
+        free(color_buffers[i].pixels);
+    }
     free(z_buffer);
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_DestroyTexture(color_buffer_texture);
+    free(z_epochs);
+    free(resolve_buffer);
+
+    if (display_backend == DISPLAY_SDL) {
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_DestroyTexture(color_buffer_texture);
+    }
     SDL_Quit();
 }
\ No newline at end of file
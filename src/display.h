@@ -8,11 +8,51 @@
 #define FPS 60
 #define FRAME_TARGET_TIME (1000 / FPS)
 
+// Number of color buffers, the next frame is drawn into one while another is presented
+#define NUM_COLOR_BUFFERS 2
+
+// Square tiles of 8x8 pixels stored contiguously in the tiled framebuffer layout
+#define FRAMEBUFFER_TILE_SHIFT 3
+#define FRAMEBUFFER_TILE_SIZE (1 << FRAMEBUFFER_TILE_SHIFT)
+
+// Largest depth values of the fixed-point depth formats
+#define DEPTH_UNORM16_MAX 0xFFFF
+#define DEPTH_UNORM24_MAX 0xFFFFFF
+
+// Screen rectangle covering the pixels min_x <= x < max_x and min_y <= y < max_y
+typedef struct {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+} screen_rect_t;
+
+enum display_backend {
+    DISPLAY_SDL,
+    DISPLAY_HEADLESS
+};
+
+enum framebuffer_layout {
+    FRAMEBUFFER_LINEAR,
+    FRAMEBUFFER_TILED
+};
+
 enum cull_method {
     CULL_NONE,
     CULL_BACKFACE
 };
 
+enum depth_clear_method {
+    DEPTH_CLEAR_FULL,
+    DEPTH_CLEAR_EPOCH
+};
+
+enum depth_format {
+    DEPTH_FORMAT_FLOAT32,
+    DEPTH_FORMAT_UNORM24,
+    DEPTH_FORMAT_UNORM16
+};
+
 enum render_method {
     RENDER_WIRE,
     RENDER_WIRE_VERTEX,
@@ -22,6 +62,12 @@ enum render_method {
     RENDER_TEXTURED_WIRE
 };
 
+void set_display_backend(int backend);
+bool is_display_headless(void);
+void set_window_size(int width, int height);
+void set_framebuffer_layout(int layout);
+void set_frame_output(const char* path, int format);
+
 bool initalize_window(void);
 int get_window_width(void);
 int get_window_height(void);
@@ -29,6 +75,10 @@ int get_window_height(void);
 void set_render_method(int method);
 void set_cull_method(int method);
 bool is_cull_backface(void);
+void set_depth_clear_method(int method);
+void set_depth_format(int format);
+void set_depth_range(float z_near, float z_far);
+uint32_t get_depth_value(float depth);
 
 bool should_render_filled_triangles(void);
 bool should_render_textured_triangles(void);
@@ -40,12 +90,23 @@ void draw_line(int x0, int y0, int x1, int y1, uint32_t color);
 void draw_grid(void);
 void draw_rect(int x, int y, int width, int height, uint32_t color);
 
+screen_rect_t get_empty_screen_rect(void);
+screen_rect_t get_screen_rect_union(screen_rect_t a, screen_rect_t b);
+bool is_screen_rect_empty(screen_rect_t rect);
+bool are_screen_rects_equal(screen_rect_t a, screen_rect_t b);
+
+void invalidate_screen(void);
+void invalidate_screen_rect(screen_rect_t rect);
+screen_rect_t get_dirty_rect(void);
+bool is_screen_dirty(void);
+
+void swap_color_buffers(void);
 void render_color_buffer(void);
 void clear_color_buffer(uint32_t color);
 void clear_z_buffer(void);
 
-float get_z_buffer_at(int x, int y);
-void update_z_buffer_at(int x, int y, float value);
+uint32_t get_z_buffer_at(int x, int y);
+void update_z_buffer_at(int x, int y, uint32_t value);
 
 void destroy_window(void);
 
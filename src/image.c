@@ -0,0 +1,188 @@
+#include "image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Largest block an uncompressed deflate block can hold
+#define MAX_STORED_BLOCK_SIZE 65535
+
+static uint32_t crc_table[256];
+static bool is_crc_table_ready = false;
+
+static void init_crc_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 1) ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+        }
+        crc_table[i] = crc;
+    }
+    is_crc_table_ready = true;
+}
+
+static uint32_t update_crc(uint32_t crc, const uint8_t* data, size_t length) {
+    if (!is_crc_table_ready) {
+        init_crc_table();
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void write_u32_be(uint8_t* out, uint32_t value) {
+    out[0] = (value >> 24) & 0xFF;
+    out[1] = (value >> 16) & 0xFF;
+    out[2] = (value >> 8) & 0xFF;
+    out[3] = value & 0xFF;
+}
+
+static bool write_png_chunk(FILE* file, const char* type, const uint8_t* data, uint32_t length) {
+    uint8_t header[8];
+    write_u32_be(header, length);
+    memcpy(header + 4, type, 4);
+
+    // Chunk checksum covers the type and the data but not the length
+    uint32_t crc = update_crc(0xFFFFFFFF, header + 4, 4);
+    crc = update_crc(crc, data, length) ^ 0xFFFFFFFF;
+
+    uint8_t footer[4];
+    write_u32_be(footer, crc);
+
+    bool is_written = fwrite(header, 1, 8, file) == 8;
+    // Chunks without data, like IEND, have nothing to write between the header and the checksum
+    if (length > 0) {
+        is_written = fwrite(data, 1, length, file) == length && is_written;
+    }
+    return fwrite(footer, 1, 4, file) == 4 && is_written;
+}
+
+// Color buffer pixels hold the bytes R, G, B and A in memory order, which is A << 24 | B << 16 | G << 8 | R
+static void get_pixel_rgb(uint32_t pixel, uint8_t* rgb) {
+    rgb[0] = pixel & 0xFF;
+    rgb[1] = (pixel >> 8) & 0xFF;
+    rgb[2] = (pixel >> 16) & 0xFF;
+}
+
+static bool write_ppm(FILE* file, uint32_t* pixels, int width, int height) {
+    bool is_written = fprintf(file, "P6\n%d %d\n255\n", width, height) > 0;
+
+    size_t row_size = (size_t)width * 3;
+    uint8_t* row = (uint8_t*)malloc(row_size);
+    for (int y = 0; y < height && is_written; y++) {
+        for (int x = 0; x < width; x++) {
+            get_pixel_rgb(pixels[(y * width) + x], &row[x * 3]);
+        }
+        is_written = fwrite(row, 1, row_size, file) == row_size;
+    }
+    free(row);
+
+    return is_written;
+}
+
+static bool write_png(FILE* file, uint32_t* pixels, int width, int height) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    bool is_written = fwrite(signature, 1, 8, file) == 8;
+
+    // 8-bit RGB, no interlacing
+    uint8_t header[13];
+    write_u32_be(header, width);
+    write_u32_be(header + 4, height);
+    header[8] = 8;
+    header[9] = 2;
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    is_written = write_png_chunk(file, "IHDR", header, 13) && is_written;
+
+    // Every scanline starts with filter type 0 followed by the raw RGB bytes
+    size_t row_size = (size_t)width * 3 + 1;
+    size_t image_size = row_size * height;
+    uint8_t* image = (uint8_t*)malloc(image_size);
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = &image[y * row_size];
+        row[0] = 0;
+        for (int x = 0; x < width; x++) {
+            get_pixel_rgb(pixels[(y * width) + x], &row[1 + x * 3]);
+        }
+    }
+
+    // Wrap the scanlines in a zlib stream of stored (uncompressed) deflate blocks
+    size_t num_blocks = (image_size + MAX_STORED_BLOCK_SIZE - 1) / MAX_STORED_BLOCK_SIZE;
+    if (num_blocks == 0) num_blocks = 1;
+    size_t stream_size = 2 + num_blocks * 5 + image_size + 4;
+    uint8_t* stream = (uint8_t*)malloc(stream_size);
+    uint8_t* out = stream;
+
+    *out++ = 0x78;
+    *out++ = 0x01;
+
+    size_t offset = 0;
+    uint32_t adler_a = 1;
+    uint32_t adler_b = 0;
+    for (size_t block = 0; block < num_blocks; block++) {
+        size_t length = image_size - offset;
+        if (length > MAX_STORED_BLOCK_SIZE) length = MAX_STORED_BLOCK_SIZE;
+
+        *out++ = block == num_blocks - 1 ? 1 : 0;
+        *out++ = length & 0xFF;
+        *out++ = (length >> 8) & 0xFF;
+        *out++ = ~length & 0xFF;
+        *out++ = (~length >> 8) & 0xFF;
+        memcpy(out, &image[offset], length);
+        out += length;
+
+        for (size_t i = 0; i < length; i++) {
+            adler_a = (adler_a + image[offset + i]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+        offset += length;
+    }
+
+    write_u32_be(out, (adler_b << 16) | adler_a);
+    is_written = write_png_chunk(file, "IDAT", stream, stream_size) && is_written;
+    is_written = write_png_chunk(file, "IEND", NULL, 0) && is_written;
+
+    free(stream);
+    free(image);
+
+    return is_written;
+}
+
+static bool write_raw(FILE* file, uint32_t* pixels, int width, int height) {
+    // Raw frames are the RGBA bytes of the color buffer without any header
+    size_t num_pixels = (size_t)width * height;
+    return fwrite(pixels, sizeof(uint32_t), num_pixels, file) == num_pixels;
+}
+
+const char* get_image_extension(int format) {
+    switch (format) {
+        case IMAGE_PNG: return "png";
+        case IMAGE_RAW: return "raw";
+        default: return "ppm";
+    }
+}
+
+bool write_image(const char* filename, int format, uint32_t* pixels, int width, int height) {
+    FILE* file = fopen(filename, "wb");
+
+    if (!file) {
+        fprintf(stderr, "Error opening %s for writing.\n", filename);
+        return false;
+    }
+
+    bool is_written;
+    switch (format) {
+        case IMAGE_PNG: is_written = write_png(file, pixels, width, height); break;
+        case IMAGE_RAW: is_written = write_raw(file, pixels, width, height); break;
+        default: is_written = write_ppm(file, pixels, width, height); break;
+    }
+
+    if (fclose(file) != 0 || !is_written) {
+        fprintf(stderr, "Error writing %s.\n", filename);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum image_format {
+    IMAGE_PPM,
+    IMAGE_PNG,
+    IMAGE_RAW
+};
+
+const char* get_image_extension(int format);
+bool write_image(const char* filename, int format, uint32_t* pixels, int width, int height);
+
+#endif
@@ -0,0 +1,145 @@
+#include "instance.h"
+#include "array.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static instance_t* instances = NULL;
+
+static bool vec3_equal(vec3_t a, vec3_t b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static void build_world_matrix(instance_t* instance) {
+    // Create scale, translation, and rotation matrices to scale the mesh vertices
+    mat4_t scale_matrix = mat4_make_scale(instance->scale.x, instance->scale.y, instance->scale.z);
+    mat4_t translation_matrix = mat4_make_translation(instance->translation.x, instance->translation.y, instance->translation.z);
+    mat4_t rotation_x_matrix = mat4_make_rotation_x(instance->rotation.x);
+    mat4_t rotation_y_matrix = mat4_make_rotation_y(instance->rotation.y);
+    mat4_t rotation_z_matrix = mat4_make_rotation_z(instance->rotation.z);
+
+    // Crate a world matrix based on scale, rotation, and translation
+    mat4_t world_matrix = mat4_identity();
+    world_matrix = mat4_mul_mat4(scale_matrix, world_matrix);
+    world_matrix = mat4_mul_mat4(rotation_x_matrix, world_matrix);
+    world_matrix = mat4_mul_mat4(rotation_y_matrix, world_matrix);
+    world_matrix = mat4_mul_mat4(rotation_z_matrix, world_matrix);
+    world_matrix = mat4_mul_mat4(translation_matrix, world_matrix);
+
+    instance->world_matrix = world_matrix;
+
+    // Invert the world matrix by applying the inverse transforms in reverse order
+    vec3_t s = instance->scale;
+    mat4_t inverse_world_matrix = mat4_make_translation(-instance->translation.x, -instance->translation.y, -instance->translation.z);
+    inverse_world_matrix = mat4_mul_mat4(mat4_make_rotation_z(-instance->rotation.z), inverse_world_matrix);
+    inverse_world_matrix = mat4_mul_mat4(mat4_make_rotation_y(-instance->rotation.y), inverse_world_matrix);
+    inverse_world_matrix = mat4_mul_mat4(mat4_make_rotation_x(-instance->rotation.x), inverse_world_matrix);
+    inverse_world_matrix = mat4_mul_mat4(mat4_make_scale(1 / s.x, 1 / s.y, 1 / s.z), inverse_world_matrix);
+    instance->inverse_world_matrix = inverse_world_matrix;
+
+    // Normals transform with the inverse transpose, which is the rotation times the inverse scale.
+    // Mirroring flips the winding of the faces, so the normal is flipped as well
+    instance->winding = (s.x * s.y * s.z < 0) ? -1 : 1;
+    instance->is_uniform_scale = fabs(s.x) == fabs(s.y) && fabs(s.y) == fabs(s.z);
+
+    float normal_scale = instance->is_uniform_scale ? fabs(s.x) : 1;
+    mat4_t normal_matrix = mat4_make_scale(
+        instance->winding * normal_scale / s.x,
+        instance->winding * normal_scale / s.y,
+        instance->winding * normal_scale / s.z
+    );
+    normal_matrix = mat4_mul_mat4(rotation_x_matrix, normal_matrix);
+    normal_matrix = mat4_mul_mat4(rotation_y_matrix, normal_matrix);
+    normal_matrix = mat4_mul_mat4(rotation_z_matrix, normal_matrix);
+    instance->normal_matrix = normal_matrix;
+    instance->world_rotation = instance->rotation;
+    instance->world_scale = instance->scale;
+    instance->world_translation = instance->translation;
+
+    // Find the world space bounding box of the transformed mesh bounding box corners
+    mesh_t* mesh = instance->mesh;
+    for (int i = 0; i < 8; i++) {
+        vec4_t corner = {
+            (i & 1) ? mesh->bounds_max.x : mesh->bounds_min.x,
+            (i & 2) ? mesh->bounds_max.y : mesh->bounds_min.y,
+            (i & 4) ? mesh->bounds_max.z : mesh->bounds_min.z,
+            1
+        };
+        vec3_t v = vec3_from_vec4(mat4_mul_vec4(world_matrix, corner));
+
+        if (i == 0) {
+            instance->bounds_min = v;
+            instance->bounds_max = v;
+        } else {
+            instance->bounds_min = vec3_new(fmin(instance->bounds_min.x, v.x), fmin(instance->bounds_min.y, v.y), fmin(instance->bounds_min.z, v.z));
+            instance->bounds_max = vec3_new(fmax(instance->bounds_max.x, v.x), fmax(instance->bounds_max.y, v.y), fmax(instance->bounds_max.z, v.z));
+        }
+    }
+}
+
+int add_instance(mesh_t* mesh, vec3_t scale, vec3_t translation, vec3_t rotation) {
+    instance_t instance = {
+        .mesh = mesh,
+        .rotation = rotation,
+        .scale = scale,
+        .translation = translation,
+        .lod = 0
+    };
+
+    build_world_matrix(&instance);
+
+    array_push(instances, instance);
+
+    // Return an index since the instance array may move when it grows
+    return array_length(instances) - 1;
+}
+
+bool update_instance_world_matrix(instance_t* instance) {
+    // Only rebuild the world matrix if the instance moved, rotated or was scaled
+    if (vec3_equal(instance->rotation, instance->world_rotation) &&
+        vec3_equal(instance->scale, instance->world_scale) &&
+        vec3_equal(instance->translation, instance->world_translation)) {
+        return false;
+    }
+
+    build_world_matrix(instance);
+
+    // Projected triangles of the old transform are no longer valid
+    instance->is_cache_valid = false;
+    return true;
+}
+
+int get_num_instances(void) {
+    return array_length(instances);
+}
+
+instance_t* get_instance(int index) {
+    return &instances[index];
+}
+
+void cache_instance_triangles(instance_t* instance, triangle_t* triangles, int num_triangles) {
+    if (num_triangles > instance->max_cached_triangles) {
+        instance->max_cached_triangles = num_triangles;
+        instance->cached_triangles = (triangle_t*)realloc(instance->cached_triangles, sizeof(triangle_t) * num_triangles);
+    }
+    if (num_triangles > 0) {
+        memcpy(instance->cached_triangles, triangles, sizeof(triangle_t) * num_triangles);
+    }
+
+    instance->num_cached_triangles = num_triangles;
+    instance->is_cache_valid = true;
+}
+
+void invalidate_instance_caches(void) {
+    for (int i = 0; i < array_length(instances); i++) {
+        instances[i].is_cache_valid = false;
+    }
+}
+
+void free_instances(void) {
+    for (int i = 0; i < array_length(instances); i++) {
+        free(instances[i].cached_triangles);
+    }
+    array_free(instances);
+    instances = NULL;
+}
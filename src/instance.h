@@ -0,0 +1,47 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include <stdbool.h>
+#include "vector.h"
+#include "matrix.h"
+#include "mesh.h"
+#include "display.h"
+
+typedef struct {
+    mesh_t* mesh;                         // shared mesh geometry and texture
+    vec3_t rotation;                      // instance rotation with x, y and z values
+    vec3_t scale;                         // instance scale with x, y and z values
+    vec3_t translation;                   // instance translation with x, y and z values
+    int lod;                              // mesh level of detail selected for the current frame
+    float view_distance;                  // distance from the camera to the bounding sphere center for the current frame
+    float screen_radius;                  // projected bounding sphere radius in pixels for the current frame
+    mat4_t world_matrix;                  // world matrix built from the instance rotation, scale and translation
+    vec3_t world_rotation;                // rotation the world matrix was built from
+    vec3_t world_scale;                   // scale the world matrix was built from
+    vec3_t world_translation;             // translation the world matrix was built from
+    mat4_t inverse_world_matrix;          // world matrix inverse to bring world positions into object space
+    mat4_t normal_matrix;                 // rotation and inverse scale that take object space face normals to world space
+    bool is_uniform_scale;                // scale has the same magnitude on every axis, so the normal matrix keeps normals unit length
+    float winding;                        // -1 if the scale mirrors the mesh and flips its faces, 1 otherwise
+    triangle_t* cached_triangles;         // projected triangles kept from the last frame the instance was processed
+    int num_cached_triangles;             // number of cached projected triangles
+    int max_cached_triangles;             // capacity of the cached triangles array
+    bool is_cache_valid;                  // cached triangles can be reused since neither the camera nor the instance moved
+    bool is_reused;                       // triangles of the current frame came from the cache
+    screen_rect_t screen_bounds;          // screen area covered by the instance triangles in the current frame
+    screen_rect_t previous_screen_bounds; // screen area covered by the instance triangles in the previous frame
+    vec3_t bounds_min;                    // world space bounding box minimum corner
+    vec3_t bounds_max;                    // world space bounding box maximum corner
+} instance_t;
+
+int add_instance(mesh_t* mesh, vec3_t scale, vec3_t translation, vec3_t rotation);
+bool update_instance_world_matrix(instance_t* instance);
+void cache_instance_triangles(instance_t* instance, triangle_t* triangles, int num_triangles);
+void invalidate_instance_caches(void);
+
+int get_num_instances(void);
+instance_t* get_instance(int index);
+
+void free_instances(void);
+
+#endif
@@ -0,0 +1,222 @@
+#include "loader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "mesh.h"
+#include "instance.h"
+#include "upng.h"
+
+typedef struct load_request {
+    char* obj_filename;
+    char* png_filename;
+    vec3_t scale;
+    vec3_t translation;
+    vec3_t rotation;
+    mesh_t* geometry;           // geometry taken from the cache, or parsed by the loader thread
+    upng_t* texture;            // texture taken from the cache, or decoded by the loader thread
+    bool needs_geometry;        // geometry was not cached and has to be parsed by the loader thread
+    bool needs_texture;         // texture was not cached and has to be decoded by the loader thread
+    struct load_request* next;
+} load_request_t;
+
+typedef struct {
+    load_request_t* head;
+    load_request_t* tail;
+} load_queue_t;
+
+static SDL_Thread* loader_thread = NULL;
+static SDL_mutex* loader_mutex = NULL;
+static SDL_sem* pending_sem = NULL;
+static SDL_atomic_t num_completed;
+static SDL_atomic_t is_stopping;
+
+static load_queue_t pending_queue = {NULL, NULL};
+static load_queue_t completed_queue = {NULL, NULL};
+
+static void queue_push(load_queue_t* queue, load_request_t* request) {
+    request->next = NULL;
+    if (queue->tail != NULL) {
+        queue->tail->next = request;
+    } else {
+        queue->head = request;
+    }
+    queue->tail = request;
+}
+
+static load_request_t* queue_pop(load_queue_t* queue) {
+    load_request_t* request = queue->head;
+    if (request != NULL) {
+        queue->head = request->next;
+        if (queue->head == NULL) {
+            queue->tail = NULL;
+        }
+    }
+    return request;
+}
+
+static char* copy_string(char* string) {
+    char* copy = (char*)malloc(strlen(string) + 1);
+    strcpy(copy, string);
+    return copy;
+}
+
+static void free_request(load_request_t* request) {
+    // Loaded copies are owned by the request, cached ones only hold a reference
+    if (request->geometry != NULL) {
+        if (request->needs_geometry) free_mesh_geometry(request->geometry);
+        else release_mesh_geometry(request->geometry);
+    }
+    if (request->texture != NULL) {
+        if (request->needs_texture) upng_free(request->texture);
+        else release_mesh_texture(request->texture);
+    }
+    free(request->obj_filename);
+    free(request->png_filename);
+    free(request);
+}
+
+static int loader_thread_main(void* data) {
+    (void)data;
+    while (true) {
+        SDL_SemWait(pending_sem);
+
+        if (SDL_AtomicGet(&is_stopping)) {
+            break;
+        }
+
+        SDL_LockMutex(loader_mutex);
+        load_request_t* request = queue_pop(&pending_queue);
+        SDL_UnlockMutex(loader_mutex);
+
+        if (request == NULL) continue;
+
+        // Parse and decode whatever was not cached, without touching the scene or the asset caches
+        if (request->needs_geometry) {
+            request->geometry = load_mesh_geometry(request->obj_filename);
+        }
+
+        if (request->needs_texture) {
+            mesh_t texture_mesh = {0};
+            load_mesh_png_data(&texture_mesh, request->png_filename);
+            request->texture = texture_mesh.texture;
+        }
+
+        SDL_LockMutex(loader_mutex);
+        queue_push(&completed_queue, request);
+        SDL_UnlockMutex(loader_mutex);
+
+        // Publish the count last so the render thread only locks once the request is queued
+        SDL_AtomicAdd(&num_completed, 1);
+    }
+
+    return 0;
+}
+
+void init_mesh_loader(void) {
+    SDL_AtomicSet(&num_completed, 0);
+    SDL_AtomicSet(&is_stopping, 0);
+
+    loader_mutex = SDL_CreateMutex();
+    pending_sem = SDL_CreateSemaphore(0);
+    loader_thread = SDL_CreateThread(loader_thread_main, "mesh loader", NULL);
+
+    if (!loader_thread) {
+        fprintf(stderr, "Error creating mesh loader thread.\n");
+    }
+}
+
+void request_mesh_load(char* obj_filename, char* png_filename, vec3_t scale, vec3_t translation, vec3_t rotation) {
+    // Load synchronously if the loader thread could not be started
+    if (!loader_thread) {
+        mesh_t* mesh = load_mesh(obj_filename, png_filename);
+        add_instance(mesh, scale, translation, rotation);
+        return;
+    }
+
+    // Assets that are already resident are used right away, only missing ones go to the loader thread
+    mesh_t* geometry = acquire_mesh_geometry(obj_filename);
+    upng_t* texture = acquire_mesh_texture(png_filename);
+
+    if (geometry != NULL && texture != NULL) {
+        mesh_t* mesh = add_mesh(geometry, texture);
+        add_instance(mesh, scale, translation, rotation);
+        return;
+    }
+
+    load_request_t* request = (load_request_t*)calloc(1, sizeof(load_request_t));
+    request->obj_filename = copy_string(obj_filename);
+    request->png_filename = copy_string(png_filename);
+    request->scale = scale;
+    request->translation = translation;
+    request->rotation = rotation;
+    request->geometry = geometry;
+    request->texture = texture;
+    request->needs_geometry = geometry == NULL;
+    request->needs_texture = texture == NULL;
+
+    SDL_LockMutex(loader_mutex);
+    queue_push(&pending_queue, request);
+    SDL_UnlockMutex(loader_mutex);
+
+    SDL_SemPost(pending_sem);
+}
+
+void publish_loaded_meshes(void) {
+    // Most frames have nothing to publish and only read the counter
+    if (SDL_AtomicGet(&num_completed) == 0) {
+        return;
+    }
+
+    SDL_LockMutex(loader_mutex);
+    load_request_t* request = completed_queue.head;
+    SDL_AtomicSet(&num_completed, 0);
+    completed_queue.head = NULL;
+    completed_queue.tail = NULL;
+    SDL_UnlockMutex(loader_mutex);
+
+    // Add the completed meshes and their instances to the scene
+    while (request != NULL) {
+        load_request_t* next = request->next;
+
+        // Cache what the loader thread read, unless another request cached the same file meanwhile
+        mesh_t* geometry = request->geometry;
+        if (request->needs_geometry) {
+            geometry = cache_mesh_geometry(request->obj_filename, geometry);
+        }
+
+        upng_t* texture = request->texture;
+        if (request->needs_texture) {
+            texture = cache_mesh_texture(request->png_filename, texture);
+        }
+
+        mesh_t* mesh = add_mesh(geometry, texture);
+        add_instance(mesh, request->scale, request->translation, request->rotation);
+
+        request->geometry = NULL;
+        request->texture = NULL;
+        free_request(request);
+
+        request = next;
+    }
+}
+
+void destroy_mesh_loader(void) {
+    if (loader_thread) {
+        SDL_AtomicSet(&is_stopping, 1);
+        SDL_SemPost(pending_sem);
+        SDL_WaitThread(loader_thread, NULL);
+        loader_thread = NULL;
+    }
+
+    // Drop requests that were never loaded or never published
+    load_request_t* request;
+    while ((request = queue_pop(&pending_queue)) != NULL) free_request(request);
+    while ((request = queue_pop(&completed_queue)) != NULL) free_request(request);
+
+    if (pending_sem) SDL_DestroySemaphore(pending_sem);
+    if (loader_mutex) SDL_DestroyMutex(loader_mutex);
+    pending_sem = NULL;
+    loader_mutex = NULL;
+}
@@ -0,0 +1,11 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "vector.h"
+
+void init_mesh_loader(void);
+void request_mesh_load(char* obj_filename, char* png_filename, vec3_t scale, vec3_t translation, vec3_t rotation);
+void publish_loaded_meshes(void);
+void destroy_mesh_loader(void);
+
+#endif
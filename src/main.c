@@ -1,11 +1,16 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include <SDL2/SDL.h>
 #include "array.h"
 #include "display.h"
 #include "vector.h"
 #include "mesh.h"
+#include "instance.h"
+#include "loader.h"
+#include "bvh.h"
+#include "occlusion.h"
 #include "triangle.h"
 #include "matrix.h"
 #include "light.h"
@@ -13,15 +18,73 @@
 #include "upng.h"
 #include "camera.h"
 #include "clipping.h"
+#include "transform.h"
+#include "worker.h"
+#include "arena.h"
+#include "sort.h"
+#include "image.h"
+
+// Meshes are only split across worker threads if each one gets at least this many faces
+#define MIN_FACES_PER_WORKER 256
+
+// Pixels added around the screen bounds of triangles so vertex markers are covered as well
+#define SCREEN_BOUNDS_PADDING 4
+
+// Starting capacity of the triangles to render when there is no previous frame to size it
+#define MIN_TRIANGLES_TO_RENDER 1024
+
+// Growable array of triangles written by a single geometry worker into its own arena
+typedef struct {
+    triangle_t* triangles;
+    int num_triangles;
+    int max_triangles;
+    arena_t arena;
+} triangle_bin_t;
+
+// Face clusters of one mesh instance, shared by all geometry workers
+typedef struct {
+    instance_t* instance;
+    meshlet_t* meshlets;
+    int num_meshlets;
+    mat4_t world_view_matrix;
+    mat4_t normal_matrix;       // takes object space face normals to camera space
+    vec3_t camera_position;     // camera position in object space
+    float max_scale;
+    bool is_uniform_scale;
+    int visibility;
+} geometry_job_t;
 
 triangle_t* triangles_to_render = NULL;
 int num_triangles_to_render = 0;
+int max_triangles_to_render = 0;
+
+// Output bins of the geometry workers, appended to the triangles to render in worker order
+triangle_bin_t geometry_bins[MAX_WORKERS];
+
+// Transient pipeline data of the current frame, released all at once when the next frame starts
+arena_t frame_arena = {NULL, NULL, NULL};
+
+// Scene state the current triangles to render were produced with
+int num_processed_instances = -1;
+int processed_pipeline_settings = -1;
+
+// Camera, clip and screen space vertices of the mesh instance being processed
+vec3_soa_t camera_vertices = {NULL, NULL, NULL};
+vec4_soa_t clip_vertices = {NULL, NULL, NULL, NULL};
+vec4_soa_t screen_vertices = {NULL, NULL, NULL, NULL};
+int* camera_vertex_outcodes = NULL;
+
+// Indices of the instances found in the view frustum by the bounding volume hierarchy
+int* visible_instances = NULL;
 
 bool is_running = false;
 uint64_t previous_frame_time = 0;
 float delta_time = 0;
 
-mat4_t world_matrix;
+// Stop after this many frames, or run until the window is closed if zero
+int max_frames = 0;
+int num_frames = 0;
+
 mat4_t proj_matrix;
 mat4_t view_matrix;
 
@@ -30,6 +93,24 @@ void setup(void) {
     set_render_method(RENDER_TEXTURED);
     set_cull_method(CULL_BACKFACE);
 
+    // Tag depth values with the frame they were written in instead of clearing the z buffer every frame
+    set_depth_clear_method(DEPTH_CLEAR_EPOCH);
+
+    // Store depth as 24-bit fixed point with the frame epoch in the same word to halve depth buffer traffic
+    set_depth_format(DEPTH_FORMAT_UNORM24);
+
+    // Skip instances hidden behind nearer ones
+    set_occlusion_method(OCCLUSION_DEPTH_BUFFER);
+
+    // Draw triangles front to back so the z-buffer rejects hidden pixels before they are textured
+    set_sort_method(SORT_TRIANGLES);
+
+    // Reorder mesh faces at load time for better vertex locality
+    set_mesh_optimize_method(MESH_OPTIMIZE_VERTEX_CACHE);
+
+    // Store mesh vertices and texture coordinates as 16-bit values to reduce memory traffic
+    set_mesh_storage_method(MESH_STORAGE_QUANTIZED);
+
     // Initialize scene light direction
     init_light(vec3_new(0, 0, 1));
 
@@ -48,21 +129,19 @@ void setup(void) {
     // Initialize frustum planes
     init_frustum_planes(fov_x, fov_y, z_near, z_far);
 
-    // Load mesh data (OBJ and PNG texture) and apply initialized transformations
-    load_mesh("./assets/crab.obj", "./assets/crab.png", vec3_new(1, 1, 1), vec3_new(-3, 0, 10), vec3_new(0, 0, 0));
-    load_mesh("./assets/f22.obj", "./assets/f22.png", vec3_new(1, 1, 1), vec3_new(3, 0, 10), vec3_new(0, 0, 0));
+    // Spread the fixed-point depth formats over the range between the near and far planes
+    set_depth_range(z_near, z_far);
 
-    // Find maximum number of triagles in the meshes and ininialize the size of triangles_to_render
-    int max_size = 0;
-    for (int i = 0; i < get_num_meshes(); i++) {
-        mesh_t* mesh = get_mesh(i);
-        int num_triangles = array_length(mesh->faces);
+    // Start the threads that split the geometry stage of large meshes
+    init_workers();
 
-        if (num_triangles > max_size) {
-            max_size = num_triangles;
-        }
+    // Stream mesh data (OBJ and PNG texture) in the background and place instances as it finishes loading.
+    // Headless frames are written out, so meshes load up front and every frame shows the full scene
+    if (!is_display_headless()) {
+        init_mesh_loader();
     }
-    triangles_to_render = (triangle_t*)malloc(sizeof(triangle_t) * max_size);
+    request_mesh_load("./assets/crab.obj", "./assets/crab.png", vec3_new(1, 1, 1), vec3_new(-3, 0, 5), vec3_new(0, 0, 0));
+    request_mesh_load("./assets/f22.obj", "./assets/f22.png", vec3_new(1, 1, 1), vec3_new(3, 0, 5), vec3_new(0, 0, 0));
 }
 
 void process_input(void) {
@@ -89,6 +168,24 @@ void process_input(void) {
                 if (event.key.keysym.sym == SDLK_6) set_render_method(RENDER_TEXTURED_WIRE);
                 if (event.key.keysym.sym == SDLK_c) set_cull_method(CULL_BACKFACE);
                 if (event.key.keysym.sym == SDLK_x) set_cull_method(CULL_NONE);
+                if (event.key.keysym.sym == SDLK_o) set_occlusion_method(OCCLUSION_DEPTH_BUFFER);
+                if (event.key.keysym.sym == SDLK_p) set_occlusion_method(OCCLUSION_NONE);
+                if (event.key.keysym.sym == SDLK_t) set_sort_method(SORT_TRIANGLES);
+                if (event.key.keysym.sym == SDLK_y) set_sort_method(SORT_INSTANCES);
+                if (event.key.keysym.sym == SDLK_u) set_sort_method(SORT_NONE);
+                if (event.key.keysym.sym == SDLK_f) set_depth_format(DEPTH_FORMAT_FLOAT32);
+                if (event.key.keysym.sym == SDLK_g) set_depth_format(DEPTH_FORMAT_UNORM24);
+                if (event.key.keysym.sym == SDLK_h) set_depth_format(DEPTH_FORMAT_UNORM16);
+                // Key to place another instance of the first mesh in front of the camera
+                if (event.key.keysym.sym == SDLK_i && get_num_meshes() > 0) {
+                    vec3_t position = vec3_add(get_camera_position(), vec3_mul(get_camera_direction(), 5.0));
+                    add_instance(get_mesh(0), vec3_new(1, 1, 1), position, vec3_new(0, 0, 0));
+                }
+                // Key to stream in another mesh in front of the camera while rendering continues
+                if (event.key.keysym.sym == SDLK_l) {
+                    vec3_t position = vec3_add(get_camera_position(), vec3_mul(get_camera_direction(), 5.0));
+                    request_mesh_load("./assets/drone.obj", "./assets/drone.png", vec3_new(1, 1, 1), position, vec3_new(0, 0, 0));
+                }
                 break;
 
             case SDL_MOUSEMOTION:
@@ -132,138 +229,339 @@ void process_input(void) {
     }
 }
 
-void process_graphics_pipeline_stages(mesh_t* mesh) {
-    // Create a view matrix
-    vec3_t target = get_camera_look_at_target(); //{0, 0, 1};
-    vec3_t up_direction = vec3_new(0, 1, 0);
-    view_matrix = mat4_look_at(get_camera_position(), target, up_direction);
+vec4_t project_to_screen(vec4_t clip_vertex) {
+    // Perspective divide, keeping w for perspective correct interpolation
+    vec4_t projected = {
+        clip_vertex.x / clip_vertex.w,
+        clip_vertex.y / clip_vertex.w,
+        clip_vertex.z / clip_vertex.w,
+        clip_vertex.w
+    };
 
-    // Create scale, translation, and rotation matrices to scale the mesh vertices
-    mat4_t scale_matrix = mat4_make_scale(mesh->scale.x, mesh->scale.y, mesh->scale.z);
-    mat4_t translation_matrix = mat4_make_translation(mesh->translation.x, mesh->translation.y, mesh->translation.z);
-    mat4_t rotation_x_matrix = mat4_make_rotation_x(mesh->rotation.x);
-    mat4_t rotation_y_matrix = mat4_make_rotation_y(mesh->rotation.y);
-    mat4_t rotation_z_matrix = mat4_make_rotation_z(mesh->rotation.z);
-
-    // Crate a world matrix based on scale, rotation, and translation
-    world_matrix = mat4_identity();
-    world_matrix = mat4_mul_mat4(scale_matrix, world_matrix);
-    world_matrix = mat4_mul_mat4(rotation_x_matrix, world_matrix);
-    world_matrix = mat4_mul_mat4(rotation_y_matrix, world_matrix);
-    world_matrix = mat4_mul_mat4(rotation_z_matrix, world_matrix);
-    world_matrix = mat4_mul_mat4(translation_matrix, world_matrix);
-
-    // Loop through all triangle faces of mesh
-    int num_faces = array_length(mesh->faces);
-    for (int i = 0; i < num_faces; i++) {
-        face_t mesh_face = mesh->faces[i];
-
-        vec3_t face_vertices[3];
-        face_vertices[0] = mesh->vertices[mesh_face.a];
-        face_vertices[1] = mesh->vertices[mesh_face.b];
-        face_vertices[2] = mesh->vertices[mesh_face.c];
-
-        // Loop through all 3 vertices of current face and apply transformations
-        vec4_t transformed_vertices[3];
-        for (int j = 0; j < 3; j++) {
-            vec4_t transformed_vertex = vec4_from_vec3(face_vertices[j]);
+    // Scale into view and invert y values to account for flipped screen y-coordinate system
+    projected.x *= get_window_width() / 2.0;
+    projected.y *= -(get_window_height() / 2.0);
 
-            // Apply world matrix to vertex so we convert to world space
-            transformed_vertex = mat4_mul_vec4(world_matrix, transformed_vertex);
+    // Translate to middle of screen
+    projected.x += (get_window_width() / 2.0);
+    projected.y += (get_window_height() / 2.0);
 
-            // Apply view matrix to vertex so we convert to camera space
-            transformed_vertex = mat4_mul_vec4(view_matrix, transformed_vertex);
+    return projected;
+}
 
-            // Save transformed vertex in array of transformed vertices
-            transformed_vertices[j] = transformed_vertex;
+void process_face(geometry_job_t* job, int face_index, bool needs_clipping, triangle_bin_t* bin) {
+    instance_t* instance = job->instance;
+    mesh_t* mesh = instance->mesh;
+    face_t mesh_face = get_mesh_face(mesh, instance->lod, face_index);
+    int face_indices[3] = {mesh_face.a, mesh_face.b, mesh_face.c};
+
+    // Drop the face if all its vertices are outside the same frustum plane
+    int outcode_union = 0;
+    if (needs_clipping) {
+        int outcode_a = camera_vertex_outcodes[mesh_face.a];
+        int outcode_b = camera_vertex_outcodes[mesh_face.b];
+        int outcode_c = camera_vertex_outcodes[mesh_face.c];
+
+        if (outcode_a & outcode_b & outcode_c & FRUSTUM_OUTCODES) {
+            return;
         }
+        outcode_union = outcode_a | outcode_b | outcode_c;
+    }
+
+    // Fetch the face normal and plane distance computed at load time
+    vec4_t face_plane = mesh->lod_face_planes[instance->lod][face_index];
 
-        // Calculate triangle face normal
-        vec3_t face_normal = get_triangle_normal(transformed_vertices);
+    // Perform backface culling if needed, by finding the side of the face plane the camera is on in object space
+    if (is_cull_backface()) {
+        vec3_t camera = job->camera_position;
+        float camera_side = face_plane.x * camera.x + face_plane.y * camera.y + face_plane.z * camera.z - face_plane.w;
 
-        // Perform backface culling if needed
-        if (is_cull_backface()) {
-            vec3_t camera_ray = vec3_sub(vec3_new(0, 0, 0), vec3_from_vec4(transformed_vertices[0]));
+        // Do not render triangle if it's not visible by camera
+        if (camera_side * instance->winding < 0) {
+            return;
+        }
+    }
+
+    // Bring the face normal to camera space for lighting, which only needs renormalizing for non-uniform scale
+    vec4_t object_normal = {face_plane.x, face_plane.y, face_plane.z, 0};
+    vec3_t face_normal = vec3_from_vec4(mat4_mul_vec4(job->normal_matrix, object_normal));
+    if (!instance->is_uniform_scale) {
+        vec3_normalize(&face_normal);
+    }
 
-            float dot_normal_camera = vec3_dot(face_normal, camera_ray);
+    // Split the face into triangles, clipping it in clip space only if it crosses the near or far plane
+    // or reaches outside the guard band
+    triangle_t triangles_after_clipping[MAX_NUM_POLY_TRIANGLES];
+    int num_triangles_after_clipping = 0;
 
-            // Do not render triangle if it's not visible by camera
-            if (dot_normal_camera < 0) {
-                continue;
-            }
+    if (outcode_union & (NEAR_FAR_OUTCODES | GUARD_BAND_OUTCODES)) {
+        vec4_t clip_points[3];
+        for (int j = 0; j < 3; j++) {
+            int index = face_indices[j];
+            clip_points[j] = (vec4_t){clip_vertices.x[index], clip_vertices.y[index], clip_vertices.z[index], clip_vertices.w[index]};
         }
 
-        // Create a polygon from triangle and perform clipping
         polygon_t polygon = polygon_from_triangle(
-            vec3_from_vec4(transformed_vertices[0]),
-            vec3_from_vec4(transformed_vertices[1]),
-            vec3_from_vec4(transformed_vertices[2]),
+            clip_points[0],
+            clip_points[1],
+            clip_points[2],
             mesh_face.a_uv,
             mesh_face.b_uv,
             mesh_face.c_uv
         );
+        clip_polygon_with_outcodes(&polygon, outcode_union);
+        triangles_from_polygon(&polygon, triangles_after_clipping, &num_triangles_after_clipping);
 
-        clip_polygon(&polygon);
+        // Only vertices created by clipping need their own perspective divide
+        for (int t = 0; t < num_triangles_after_clipping; t++) {
+            for (int j = 0; j < 3; j++) {
+                triangles_after_clipping[t].points[j] = project_to_screen(triangles_after_clipping[t].points[j]);
+            }
+        }
+    } else {
+        triangle_t triangle = {.tex_coords = {mesh_face.a_uv, mesh_face.b_uv, mesh_face.c_uv}};
+        for (int j = 0; j < 3; j++) {
+            int index = face_indices[j];
+            triangle.points[j] = (vec4_t){screen_vertices.x[index], screen_vertices.y[index], screen_vertices.z[index], screen_vertices.w[index]};
+        }
+        triangles_after_clipping[0] = triangle;
+        num_triangles_after_clipping = 1;
+    }
 
-        // Split polygon back into triangles
-        triangle_t triangles_after_clipping[MAX_NUM_POLY_TRIANGLES];
-        int num_triangles_after_clipping = 0;
+    // Loop through all new triangles created after clipping 
+    for (int t = 0; t < num_triangles_after_clipping; t++) {
+        triangle_t triangle_after_clipping = triangles_after_clipping[t];
+        vec4_t* projected_points = triangle_after_clipping.points;
+
+        // Perform flat shading on triangle face to find its new color based on lighting
+        float light_intensity_factor = -vec3_dot(face_normal, get_light_direction());
+        uint32_t triangle_color = light_apply_intensity(mesh_face.color, light_intensity_factor);
+
+        triangle_t triangle_to_render = {
+            .points = {
+                {projected_points[0].x, projected_points[0].y, projected_points[0].z, projected_points[0].w},
+                {projected_points[1].x, projected_points[1].y, projected_points[1].z, projected_points[1].w},
+                {projected_points[2].x, projected_points[2].y, projected_points[2].z, projected_points[2].w}
+            },
+            .tex_coords = {
+                {triangle_after_clipping.tex_coords[0].u, triangle_after_clipping.tex_coords[0].v},
+                {triangle_after_clipping.tex_coords[1].u, triangle_after_clipping.tex_coords[1].v},
+                {triangle_after_clipping.tex_coords[2].u, triangle_after_clipping.tex_coords[2].v}
+            },
+            .color = triangle_color,
+            .texture = mesh->texture
+        };
+
+        // Grow the bin when clipping or larger meshes produce more triangles
+        if (bin->num_triangles == bin->max_triangles) {
+            int max_triangles = bin->max_triangles > 0 ? bin->max_triangles * 2 : 256;
+            bin->triangles = (triangle_t*)arena_grow(
+                &bin->arena, bin->triangles, sizeof(triangle_t) * bin->max_triangles, sizeof(triangle_t) * max_triangles
+            );
+            bin->max_triangles = max_triangles;
+        }
 
-        triangles_from_polygon(&polygon, triangles_after_clipping, &num_triangles_after_clipping);
+        // Save projected triangle to the bin of the current worker
+        bin->triangles[bin->num_triangles] = triangle_to_render;
+        bin->num_triangles++;
+    }
+}
 
-        // Loop through all new triangles created after clipping 
-        for (int t = 0; t < num_triangles_after_clipping; t++) {
-            triangle_t triangle_after_clipping = triangles_after_clipping[t];
-            vec4_t projected_points[3];
+void process_meshlets(int worker_index, int num_workers, void* data) {
+    geometry_job_t* job = (geometry_job_t*)data;
+    triangle_bin_t* bin = &geometry_bins[worker_index];
 
-            // Loop through all 3 vertices of current face and project them
-            for (int j = 0; j < 3; j++) {
-                // Project current vertex
-                projected_points[j] = mat4_mul_vec4_project(proj_matrix, triangle_after_clipping.points[j]);
+    // Each worker takes a contiguous range of clusters so the bins keep the face order
+    int first_meshlet = job->num_meshlets * worker_index / num_workers;
+    int last_meshlet = job->num_meshlets * (worker_index + 1) / num_workers;
+
+    bin->num_triangles = 0;
+
+    for (int m = first_meshlet; m < last_meshlet; m++) {
+        meshlet_t* meshlet = &job->meshlets[m];
 
-                // Scale into view
-                projected_points[j].x *= get_window_width() / 2.0;
-                projected_points[j].y *= get_window_height() / 2.0;
+        vec3_t center = vec3_from_vec4(mat4_mul_vec4(job->world_view_matrix, vec4_from_vec3(meshlet->center)));
+        float radius = meshlet->radius * job->max_scale;
 
-                // Invert y values to account for flipped screen y-coordinate system
-                projected_points[j].y *= -1;
+        // Skip the whole cluster if it is outside the view frustum, and skip clipping if it is completely inside
+        int meshlet_visibility = job->visibility;
+        if (meshlet_visibility != FRUSTUM_INSIDE) {
+            meshlet_visibility = test_sphere_frustum(center, radius);
 
-                // Translate to middle of screen
-                projected_points[j].x += (get_window_width() / 2.0);
-                projected_points[j].y += (get_window_height() / 2.0);
+            if (meshlet_visibility == FRUSTUM_OUTSIDE) {
+                continue;
             }
+        }
+
+        // Skip the whole cluster if all of its faces point away from the camera
+        if (is_cull_backface() && job->is_uniform_scale) {
+            vec4_t axis = {meshlet->cone_axis.x, meshlet->cone_axis.y, meshlet->cone_axis.z, 0};
+            vec3_t cone_axis = vec3_from_vec4(mat4_mul_vec4(job->world_view_matrix, axis));
+            vec3_normalize(&cone_axis);
 
-            // Perform flat shading on triangle face to find its new color based on lighting
-            float light_intensity_factor = -vec3_dot(face_normal, get_light_direction());
-            uint32_t triangle_color = light_apply_intensity(mesh_face.color, light_intensity_factor);
-
-            triangle_t triangle_to_render = {
-                .points = {
-                    {projected_points[0].x, projected_points[0].y, projected_points[0].z, projected_points[0].w},
-                    {projected_points[1].x, projected_points[1].y, projected_points[1].z, projected_points[1].w},
-                    {projected_points[2].x, projected_points[2].y, projected_points[2].z, projected_points[2].w}
-                },
-                .tex_coords = {
-                    {triangle_after_clipping.tex_coords[0].u, triangle_after_clipping.tex_coords[0].v},
-                    {triangle_after_clipping.tex_coords[1].u, triangle_after_clipping.tex_coords[1].v},
-                    {triangle_after_clipping.tex_coords[2].u, triangle_after_clipping.tex_coords[2].v}
-                },
-                .color = triangle_color,
-                .texture = mesh->texture
+            if (is_meshlet_backfacing(meshlet, center, cone_axis, radius)) {
+                continue;
+            }
+        }
+
+        // Loop through all triangle faces of the cluster
+        for (int i = meshlet->first_face; i < meshlet->first_face + meshlet->num_faces; i++) {
+            process_face(job, i, meshlet_visibility != FRUSTUM_INSIDE, bin);
+        }
+    }
+}
+
+void append_triangles_to_render(triangle_t* triangles, int num_triangles) {
+    if (num_triangles == 0) {
+        return;
+    }
+
+    // Grow the array of triangles to render when clipping or more instances produce more triangles.
+    // It is the last allocation of the frame arena, so it grows in place unless the chunk is full
+    if (num_triangles_to_render + num_triangles > max_triangles_to_render) {
+        int max_triangles = max_triangles_to_render * 2;
+        while (num_triangles_to_render + num_triangles > max_triangles) max_triangles *= 2;
+
+        triangles_to_render = (triangle_t*)arena_grow(
+            &frame_arena, triangles_to_render, sizeof(triangle_t) * num_triangles_to_render, sizeof(triangle_t) * max_triangles
+        );
+        max_triangles_to_render = max_triangles;
+    }
+
+    memcpy(&triangles_to_render[num_triangles_to_render], triangles, sizeof(triangle_t) * num_triangles);
+    num_triangles_to_render += num_triangles;
+}
+
+void process_graphics_pipeline_stages(instance_t* instance) {
+    mesh_t* mesh = instance->mesh;
+
+    // Combine world and view matrices so vertices and cluster bounds go to camera space in one step
+    mat4_t world_view_matrix = mat4_mul_mat4(view_matrix, instance->world_matrix);
+    vec3_t scale = instance->scale;
+    float max_scale = fmax(fabs(scale.x), fmax(fabs(scale.y), fabs(scale.z)));
+
+    // Normal cones are only valid if the scale does not skew face normals
+    bool is_uniform_scale = scale.x == scale.y && scale.y == scale.z && scale.x > 0;
+
+    // Test the mesh bounding sphere against the view frustum, and its bounding box if the sphere is not conclusive
+    vec3_t bounds_center = vec3_from_vec4(mat4_mul_vec4(world_view_matrix, vec4_from_vec3(mesh->bounds_center)));
+    int visibility = test_sphere_frustum(bounds_center, mesh->bounds_radius * max_scale);
+
+    if (visibility == FRUSTUM_INTERSECTING) {
+        vec3_t corners[8];
+        for (int i = 0; i < 8; i++) {
+            vec4_t corner = {
+                (i & 1) ? mesh->bounds_max.x : mesh->bounds_min.x,
+                (i & 2) ? mesh->bounds_max.y : mesh->bounds_min.y,
+                (i & 4) ? mesh->bounds_max.z : mesh->bounds_min.z,
+                1
             };
+            corners[i] = vec3_from_vec4(mat4_mul_vec4(world_view_matrix, corner));
+        }
+        visibility = test_box_frustum(corners);
+    }
+
+    // Skip the whole mesh before touching any of its vertices or faces if it is outside the view frustum
+    if (visibility == FRUSTUM_OUTSIDE) {
+        return;
+    }
 
-            // Save projected triangle to array of triangles to render
-            triangles_to_render[num_triangles_to_render] = triangle_to_render;
-            num_triangles_to_render++;
+    // Transform all mesh vertices to camera space and then to clip space in one batch
+    transform_mesh_vertices(mesh, &world_view_matrix, camera_vertices);
+    project_vertices(&proj_matrix, camera_vertices, clip_vertices, mesh->num_vertices);
+
+    // Project each unique vertex to the screen once, faces that need clipping redo it for their new vertices
+    for (int i = 0; i < mesh->num_vertices; i++) {
+        vec4_t clip_vertex = {clip_vertices.x[i], clip_vertices.y[i], clip_vertices.z[i], clip_vertices.w[i]};
+
+        // Vertices behind the camera can only belong to faces that get clipped
+        if (clip_vertex.w > 0) {
+            vec4_t screen_vertex = project_to_screen(clip_vertex);
+            screen_vertices.x[i] = screen_vertex.x;
+            screen_vertices.y[i] = screen_vertex.y;
+            screen_vertices.z[i] = screen_vertex.z;
+            screen_vertices.w[i] = screen_vertex.w;
         }
     }
+
+    // Classify vertices against the clip space frustum once so faces can be rejected or accepted without clipping
+    if (visibility != FRUSTUM_INSIDE) {
+        for (int i = 0; i < mesh->num_vertices; i++) {
+            vec4_t clip_vertex = {clip_vertices.x[i], clip_vertices.y[i], clip_vertices.z[i], clip_vertices.w[i]};
+            camera_vertex_outcodes[i] = get_vertex_outcode(clip_vertex);
+        }
+    }
+
+    // Split the face clusters of the selected level of detail across the geometry workers
+    geometry_job_t job = {
+        .instance = instance,
+        .meshlets = mesh->lod_meshlets[instance->lod],
+        .num_meshlets = array_length(mesh->lod_meshlets[instance->lod]),
+        .world_view_matrix = world_view_matrix,
+        .normal_matrix = mat4_mul_mat4(view_matrix, instance->normal_matrix),
+        .camera_position = vec3_from_vec4(mat4_mul_vec4(instance->inverse_world_matrix, vec4_from_vec3(get_camera_position()))),
+        .max_scale = max_scale,
+        .is_uniform_scale = is_uniform_scale,
+        .visibility = visibility
+    };
+    int num_workers = 1 + mesh->lod_num_faces[instance->lod] / MIN_FACES_PER_WORKER;
+    if (num_workers > job.num_meshlets) num_workers = job.num_meshlets;
+    if (num_workers > get_num_workers()) num_workers = get_num_workers();
+    if (num_workers < 1) num_workers = 1;
+
+    run_workers(process_meshlets, &job, num_workers);
+
+    // Append the bins in worker order so triangles keep the order of their faces
+    for (int i = 0; i < num_workers; i++) {
+        append_triangles_to_render(geometry_bins[i].triangles, geometry_bins[i].num_triangles);
+    }
+}
+
+void allocate_vertex_buffers(int num_vertices) {
+    float** planes[] = {
+        &camera_vertices.x, &camera_vertices.y, &camera_vertices.z,
+        &clip_vertices.x, &clip_vertices.y, &clip_vertices.z, &clip_vertices.w,
+        &screen_vertices.x, &screen_vertices.y, &screen_vertices.z, &screen_vertices.w
+    };
+    int num_planes = sizeof(planes) / sizeof(planes[0]);
+    for (int i = 0; i < num_planes; i++) {
+        *planes[i] = (float*)arena_alloc(&frame_arena, sizeof(float) * num_vertices);
+    }
+    camera_vertex_outcodes = (int*)arena_alloc(&frame_arena, sizeof(int) * num_vertices);
+}
+
+screen_rect_t get_triangle_screen_bounds(triangle_t* triangle) {
+    float min_x = fmin(triangle->points[0].x, fmin(triangle->points[1].x, triangle->points[2].x));
+    float min_y = fmin(triangle->points[0].y, fmin(triangle->points[1].y, triangle->points[2].y));
+    float max_x = fmax(triangle->points[0].x, fmax(triangle->points[1].x, triangle->points[2].x));
+    float max_y = fmax(triangle->points[0].y, fmax(triangle->points[1].y, triangle->points[2].y));
+
+    // Pad the bounds to cover the squares drawn around vertices
+    screen_rect_t bounds = {
+        floor(min_x) - SCREEN_BOUNDS_PADDING,
+        floor(min_y) - SCREEN_BOUNDS_PADDING,
+        ceil(max_x) + SCREEN_BOUNDS_PADDING + 1,
+        ceil(max_y) + SCREEN_BOUNDS_PADDING + 1
+    };
+    return bounds;
+}
+
+int get_pipeline_settings(void) {
+    // Settings that change which triangles the geometry stage produces
+    return is_cull_backface() | (is_occlusion_culling() << 1) | (should_sort_instances() << 2) | (should_sort_triangles() << 3);
+}
+
+int compare_view_distance(const void* a, const void* b) {
+    float distance_a = get_instance(*(int*)a)->view_distance;
+    float distance_b = get_instance(*(int*)b)->view_distance;
+    return (distance_a > distance_b) - (distance_a < distance_b);
 }
 
 void update(void) {
-    // Implement fixed time steps
+    // Implement fixed time steps, headless rendering runs as fast as possible
     int time_to_wait = FRAME_TARGET_TIME - (SDL_GetTicks() - previous_frame_time);
 
-    if (time_to_wait > 0) {
+    if (time_to_wait > 0 && !is_display_headless()) {
         SDL_Delay(time_to_wait);
     }
 
@@ -272,35 +570,186 @@ void update(void) {
     
     previous_frame_time = SDL_GetTicks();
 
-    // Initialize counter of triangles to render for the current frame
-    num_triangles_to_render = 0;
+    // Add meshes that finished loading since the last frame
+    publish_loaded_meshes();
 
-    // Loop through all meshes in scene and disply them on screen
-    for (int mesh_index = 0; mesh_index < get_num_meshes(); mesh_index++) {
-        mesh_t* mesh = get_mesh(mesh_index);
+    // Update all mesh instances in scene
+    bool has_moved = false;
+    for (int instance_index = 0; instance_index < get_num_instances(); instance_index++) {
+        instance_t* instance = get_instance(instance_index);
 
         // Update rotation, scale, and translation
-        mesh->rotation.x += 0.0 * delta_time;
-        mesh->rotation.y += 0.0 * delta_time;
-        mesh->rotation.z += 0.0 * delta_time;
-        mesh->translation.z = 5;             // move mesh away from camera
+        instance->rotation.x += 0.0 * delta_time;
+        instance->rotation.y += 0.0 * delta_time;
+        instance->rotation.z += 0.0 * delta_time;
 
-        process_graphics_pipeline_stages(mesh);
+        // Rebuild the world matrix only if rotation, scale, or translation changed
+        if (update_instance_world_matrix(instance)) {
+            has_moved = true;
+        }
+    }
+
+    // Keep the triangles of the previous frame if neither the camera, the instances nor the settings changed
+    int pipeline_settings = get_pipeline_settings();
+    bool is_camera_static = !is_camera_dirty();
+    if (is_camera_static && !has_moved && get_num_instances() == num_processed_instances && pipeline_settings == processed_pipeline_settings) {
+        return;
+    }
+
+    // Instances that did not move can only reuse their triangles if the camera and culling stayed the same
+    if (!is_camera_static || (pipeline_settings & 1) != (processed_pipeline_settings & 1)) {
+        invalidate_instance_caches();
+    }
+
+    // Every pixel may change if the camera or the settings did, otherwise only the areas of changed instances
+    bool is_screen_changed = !is_camera_static || pipeline_settings != processed_pipeline_settings;
+    if (is_screen_changed) {
+        invalidate_screen();
+    }
+    clear_camera_dirty();
+    num_processed_instances = get_num_instances();
+    processed_pipeline_settings = pipeline_settings;
+
+    // Release the transient data of the previous frame
+    arena_reset(&frame_arena);
+    for (int i = 0; i < MAX_WORKERS; i++) {
+        arena_reset(&geometry_bins[i].arena);
+        geometry_bins[i].triangles = NULL;
+        geometry_bins[i].max_triangles = 0;
+    }
+
+    // Create the view matrix once for all instances
+    vec3_t target = get_camera_look_at_target();
+    vec3_t up_direction = vec3_new(0, 1, 0);
+    view_matrix = mat4_look_at(get_camera_position(), target, up_direction);
+
+    // Rebuild the bounding volume hierarchy for new instances or refit it to moved ones
+    update_instance_bvh(has_moved);
+
+    // Find the instances whose hierarchy nodes touch the view frustum
+    visible_instances = (int*)arena_alloc(&frame_arena, sizeof(int) * get_num_instances());
+    update_world_frustum_planes(view_matrix);
+    int num_visible_instances = get_visible_instances(visible_instances);
+
+    // Select level of detail based on the projected size of the mesh bounding sphere
+    int max_vertices = 0;
+    for (int i = 0; i < num_visible_instances; i++) {
+        instance_t* instance = get_instance(visible_instances[i]);
+        mesh_t* mesh = instance->mesh;
+
+        vec3_t world_center = vec3_from_vec4(mat4_mul_vec4(instance->world_matrix, vec4_from_vec3(mesh->bounds_center)));
+        float distance = vec3_length(vec3_sub(world_center, get_camera_position()));
+        float max_scale = fmax(fabs(instance->scale.x), fmax(fabs(instance->scale.y), fabs(instance->scale.z)));
+        float world_radius = mesh->bounds_radius * max_scale;
+
+        instance->view_distance = distance;
+        instance->screen_radius = (distance > world_radius)
+            ? world_radius * proj_matrix.m[1][1] * (get_window_height() / 2.0) / distance
+            : get_window_height();
+        instance->lod = select_mesh_lod(mesh, instance->screen_radius);
+
+        if (mesh->num_vertices > max_vertices) {
+            max_vertices = mesh->num_vertices;
+        }
+    }
+
+    // Allocate the vertex buffers shared by all instances, sized for the largest visible mesh
+    allocate_vertex_buffers(max_vertices);
+
+    // Start the triangles to render as large as the previous frame needed, after everything else in the arena so it can grow in place
+    max_triangles_to_render = num_triangles_to_render > MIN_TRIANGLES_TO_RENDER ? num_triangles_to_render : MIN_TRIANGLES_TO_RENDER;
+    triangles_to_render = (triangle_t*)arena_alloc(&frame_arena, sizeof(triangle_t) * max_triangles_to_render);
+    num_triangles_to_render = 0;
+
+    // Process instances front to back so near instances can hide the ones behind them
+    if (is_occlusion_culling() || should_sort_instances()) {
+        qsort(visible_instances, num_visible_instances, sizeof(int), compare_view_distance);
+    }
+    if (is_occlusion_culling()) {
+        clear_occlusion_buffer();
+    }
+
+    // Instances that are not drawn this frame cover no area of the screen
+    for (int i = 0; i < get_num_instances(); i++) {
+        instance_t* instance = get_instance(i);
+        instance->previous_screen_bounds = instance->screen_bounds;
+        instance->screen_bounds = get_empty_screen_rect();
+        instance->is_reused = false;
+    }
+
+    // Loop through all visible mesh instances and disply them on screen
+    for (int i = 0; i < num_visible_instances; i++) {
+        instance_t* instance = get_instance(visible_instances[i]);
+
+        // Skip instances completely behind occluders drawn so far
+        if (is_occlusion_culling() && is_box_occluded(instance->bounds_min, instance->bounds_max, view_matrix, proj_matrix)) {
+            continue;
+        }
+
+        int first_triangle = num_triangles_to_render;
+
+        // Reuse the triangles of instances that did not change, and keep new ones while the camera is idle
+        if (instance->is_cache_valid) {
+            append_triangles_to_render(instance->cached_triangles, instance->num_cached_triangles);
+            instance->is_reused = true;
+        } else {
+            process_graphics_pipeline_stages(instance);
+
+            if (is_camera_static) {
+                cache_instance_triangles(instance, &triangles_to_render[first_triangle], num_triangles_to_render - first_triangle);
+            }
+        }
+
+        // Large instances hide what is behind them, so draw their triangles into the occlusion buffer
+        if (is_occlusion_culling() && instance->screen_radius >= OCCLUDER_MIN_SCREEN_RADIUS) {
+            rasterize_occluders(&triangles_to_render[first_triangle], num_triangles_to_render - first_triangle);
+        }
+
+        // Remember the screen area of the instance to find what changed in the next frame
+        for (int t = first_triangle; t < num_triangles_to_render; t++) {
+            instance->screen_bounds = get_screen_rect_union(instance->screen_bounds, get_triangle_screen_bounds(&triangles_to_render[t]));
+        }
+    }
+
+    // Redraw where instances appeared, disappeared or changed, both at their old and new screen areas
+    if (!is_screen_changed) {
+        for (int i = 0; i < get_num_instances(); i++) {
+            instance_t* instance = get_instance(i);
+
+            if (!instance->is_reused || !are_screen_rects_equal(instance->screen_bounds, instance->previous_screen_bounds)) {
+                invalidate_screen_rect(instance->previous_screen_bounds);
+                invalidate_screen_rect(instance->screen_bounds);
+            }
+        }
+    }
+
+    // Order the triangles of all instances by depth so near surfaces are drawn first
+    if (should_sort_triangles()) {
+        triangles_to_render = sort_triangles_front_to_back(triangles_to_render, num_triangles_to_render, &frame_arena);
     }
 }
 
-void render(void) {
-    // Clear all arrays to prepare for rendering
+void draw_frame(void* data) {
+    (void)data;
+
+    // Clear the changed region of all arrays to prepare for rendering
     clear_color_buffer(0xFF000000);
     clear_z_buffer();
 
     // Draw background grid
     draw_grid();
 
-    // Loop all projected triangles and render them  
+    // Loop all projected triangles and render the ones touching the changed region
+    screen_rect_t dirty_rect = get_dirty_rect();
     for (int i = 0; i < num_triangles_to_render; i++) {
         triangle_t triangle = triangles_to_render[i];
-        
+
+        screen_rect_t bounds = get_triangle_screen_bounds(&triangle);
+        if (bounds.max_x <= dirty_rect.min_x || bounds.min_x >= dirty_rect.max_x ||
+            bounds.max_y <= dirty_rect.min_y || bounds.min_y >= dirty_rect.max_y) {
+            continue;
+        }
+
         // Draw filled triangles
         if (should_render_filled_triangles()) {
             draw_filled_triangle(triangle, triangle.color);
@@ -323,20 +772,115 @@ void render(void) {
 
         // Draw vertices
         if (should_render_vertices()) {
-            for (int i = 0; i < sizeof(triangle.points); i++) 
+            for (int i = 0; i < 3; i++) 
                 draw_rect(triangle.points[i].x - 3, triangle.points[i].y - 3, 6, 6, 0xFF0000FF);
         }
     }
+}
+
+void render(void) {
+    // Without a window there is nothing to overlap, so each frame is written out right after it is drawn
+    if (is_display_headless()) {
+        if (is_screen_dirty()) {
+            draw_frame(NULL);
+            swap_color_buffers();
+        }
+        render_color_buffer();
+        return;
+    }
+
+    // Draw the new frame into the back buffer while the previous one is presented
+    bool is_drawing = is_screen_dirty();
+    if (is_drawing) {
+        start_background_job(draw_frame, NULL);
+    }
 
     render_color_buffer();
+
+    // Wait for the new frame so the next update can reuse the triangles and buffers
+    if (is_drawing) {
+        wait_background_job();
+        swap_color_buffers();
+    }
 }
 
 void free_resources(void) {
+    destroy_mesh_loader();
+    destroy_workers();
     destroy_window();
+    free_instance_bvh();
+    free_instances();
     free_meshes();
+    arena_free(&frame_arena);
+    for (int i = 0; i < MAX_WORKERS; i++) {
+        arena_free(&geometry_bins[i].arena);
+    }
 }
 
-int main(void) {
+void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--headless] [--tiled] [--size WIDTHxHEIGHT] [--output PATH] [--format ppm|png|raw] [--frames N]\n", program);
+}
+
+bool parse_arguments(int argc, char* argv[]) {
+    const char* output_path = NULL;
+    int output_format = IMAGE_PPM;
+
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+
+        if (strcmp(option, "--headless") == 0) {
+            set_display_backend(DISPLAY_HEADLESS);
+            continue;
+        }
+        if (strcmp(option, "--tiled") == 0) {
+            set_framebuffer_layout(FRAMEBUFFER_TILED);
+            continue;
+        }
+
+        // Every other option takes a value
+        if (i + 1 >= argc) {
+            print_usage(argv[0]);
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (strcmp(option, "--size") == 0) {
+            int width, height;
+            if (sscanf(value, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                fprintf(stderr, "Invalid size %s.\n", value);
+                return false;
+            }
+            set_window_size(width, height);
+        } else if (strcmp(option, "--output") == 0) {
+            output_path = value;
+        } else if (strcmp(option, "--format") == 0) {
+            if (strcmp(value, "ppm") == 0) output_format = IMAGE_PPM;
+            else if (strcmp(value, "png") == 0) output_format = IMAGE_PNG;
+            else if (strcmp(value, "raw") == 0) output_format = IMAGE_RAW;
+            else {
+                fprintf(stderr, "Invalid format %s.\n", value);
+                return false;
+            }
+        } else if (strcmp(option, "--frames") == 0) {
+            max_frames = atoi(value);
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (output_path) {
+        set_frame_output(output_path, output_format);
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_arguments(argc, argv)) {
+        return 1;
+    }
+
     is_running = initalize_window();
 
     setup();
@@ -345,9 +889,12 @@ int main(void) {
         process_input();
         update();
         render();
+
+        if (max_frames > 0 && ++num_frames >= max_frames) {
+            is_running = false;
+        }
     }
-    
-    destroy_window();
+
     free_resources();
 
     return 0;
@@ -1,21 +1,134 @@
 #include "mesh.h"
 #include "array.h"
+#include "optimize.h"
+#include "simplify.h"
+#include "asset.h"
+#include "transform.h"
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
-#define MAX_NUM_MESHES 10
-static mesh_t meshes[MAX_NUM_MESHES];
-static int mesh_count = 0;
+static mesh_t** meshes = NULL;
 
-void load_mesh(char* obj_filename, char* png_filename, vec3_t scale, vec3_t translation, vec3_t rotation) {
-    load_mesh_obj_data(&meshes[mesh_count], obj_filename);
-    load_mesh_png_data(&meshes[mesh_count], png_filename);
+// Loaded geometry and textures keyed by file path, shared by every mesh using them
+static asset_t* geometry_cache = NULL;
+static asset_t* texture_cache = NULL;
 
-    meshes[mesh_count].scale = scale;
-    meshes[mesh_count].translation = translation;
-    meshes[mesh_count].rotation = rotation;
+static int optimize_method = MESH_OPTIMIZE_NONE;
+static int storage_method = MESH_STORAGE_FLOAT;
 
-    mesh_count++;
+void set_mesh_optimize_method(int method) {
+    optimize_method = method;
+}
+
+void set_mesh_storage_method(int method) {
+    storage_method = method;
+}
+
+mesh_t* add_mesh(mesh_t* geometry, upng_t* texture) {
+    // Meshes are allocated individually so pointers held by instances stay valid
+    mesh_t* mesh = (mesh_t*)calloc(1, sizeof(mesh_t));
+
+    *mesh = *geometry;
+    mesh->geometry = geometry;
+    mesh->texture = texture;
+
+    array_push(meshes, mesh);
+
+    return mesh;
+}
+
+mesh_t* acquire_mesh_geometry(char* obj_filename) {
+    return acquire_asset(&geometry_cache, obj_filename);
+}
+
+upng_t* acquire_mesh_texture(char* png_filename) {
+    return acquire_asset(&texture_cache, png_filename);
+}
+
+mesh_t* cache_mesh_geometry(char* obj_filename, mesh_t* geometry) {
+    // Prefer geometry that became resident while this copy was loading
+    mesh_t* cached_geometry = acquire_asset(&geometry_cache, obj_filename);
+    if (cached_geometry != NULL) {
+        free_mesh_geometry(geometry);
+        return cached_geometry;
+    }
+
+    add_asset(&geometry_cache, obj_filename, geometry);
+    return geometry;
+}
+
+upng_t* cache_mesh_texture(char* png_filename, upng_t* texture) {
+    // Same for the texture, which stays out of the cache if it could not be decoded
+    upng_t* cached_texture = acquire_asset(&texture_cache, png_filename);
+    if (cached_texture != NULL) {
+        if (texture != NULL) upng_free(texture);
+        return cached_texture;
+    }
+
+    if (texture != NULL) {
+        add_asset(&texture_cache, png_filename, texture);
+    }
+    return texture;
+}
+
+void release_mesh_geometry(mesh_t* geometry) {
+    // Only destroy shared geometry once its last user is gone
+    mesh_t* released_geometry = release_asset(&geometry_cache, geometry);
+    if (released_geometry != NULL) {
+        free_mesh_geometry(released_geometry);
+    }
+}
+
+void release_mesh_texture(upng_t* texture) {
+    upng_t* released_texture = release_asset(&texture_cache, texture);
+    if (released_texture != NULL) {
+        upng_free(released_texture);
+    }
+}
+
+mesh_t* load_mesh(char* obj_filename, char* png_filename) {
+    // Share geometry with any mesh already loaded from the same OBJ file
+    mesh_t* geometry = acquire_mesh_geometry(obj_filename);
+    if (geometry == NULL) {
+        geometry = cache_mesh_geometry(obj_filename, load_mesh_geometry(obj_filename));
+    }
+
+    // Share the decoded texture with any mesh already using the same PNG file
+    upng_t* texture = acquire_mesh_texture(png_filename);
+    if (texture == NULL) {
+        mesh_t texture_mesh = {0};
+        load_mesh_png_data(&texture_mesh, png_filename);
+        texture = cache_mesh_texture(png_filename, texture_mesh.texture);
+    }
+
+    return add_mesh(geometry, texture);
+}
+
+mesh_t* load_mesh_geometry(char* obj_filename) {
+    mesh_t* geometry = (mesh_t*)calloc(1, sizeof(mesh_t));
+
+    load_mesh_obj_data(geometry, obj_filename);
+
+    // Reorder faces and vertices so the geometry stage reads vertex memory sequentially
+    if (optimize_method == MESH_OPTIMIZE_VERTEX_CACHE) {
+        optimize_mesh_vertex_cache(geometry);
+    }
+
+    // Compute bounding volume and simplified levels of detail
+    compute_mesh_bounds(geometry);
+    build_mesh_lods(geometry);
+
+    // Replace float vertices and texture coordinates with compact 16-bit ones, or
+    // lay out the vertices as separate x, y and z arrays for the batched transform
+    if (storage_method == MESH_STORAGE_QUANTIZED) {
+        quantize_mesh_geometry(geometry);
+    } else {
+        split_mesh_vertices(geometry);
+    }
+
+    return geometry;
 }
 
 void load_mesh_obj_data(mesh_t* mesh, char* obj_filename) {
@@ -82,22 +195,211 @@ void load_mesh_png_data(mesh_t* mesh, char* png_filename) {
 
         if (upng_get_error(png_image) == UPNG_EOK) {
             mesh->texture = png_image;
+        } else {
+            upng_free(png_image);
+        }
+    }
+}
+
+void compute_mesh_bounds(mesh_t* mesh) {
+    int num_vertices = array_length(mesh->vertices);
+
+    if (num_vertices == 0) {
+        mesh->bounds_center = vec3_new(0, 0, 0);
+        mesh->bounds_radius = 0;
+        return;
+    }
+
+    // Center the sphere on the axis aligned bounding box of the vertices
+    vec3_t min = mesh->vertices[0];
+    vec3_t max = mesh->vertices[0];
+
+    for (int i = 1; i < num_vertices; i++) {
+        vec3_t v = mesh->vertices[i];
+        min = vec3_new(fmin(min.x, v.x), fmin(min.y, v.y), fmin(min.z, v.z));
+        max = vec3_new(fmax(max.x, v.x), fmax(max.y, v.y), fmax(max.z, v.z));
+    }
+
+    mesh->bounds_min = min;
+    mesh->bounds_max = max;
+    mesh->bounds_center = vec3_mul(vec3_add(min, max), 0.5);
+    mesh->bounds_radius = 0;
+
+    for (int i = 0; i < num_vertices; i++) {
+        float distance = vec3_length(vec3_sub(mesh->vertices[i], mesh->bounds_center));
+
+        if (distance > mesh->bounds_radius) {
+            mesh->bounds_radius = distance;
+        }
+    }
+}
+
+static vec4_t* compute_face_planes(vec3_t* vertices, face_t* faces) {
+    int num_faces = array_length(faces);
+    vec4_t* planes = (vec4_t*)malloc(sizeof(vec4_t) * (num_faces > 0 ? num_faces : 1));
+
+    for (int i = 0; i < num_faces; i++) {
+        vec3_t vector_ab = vec3_sub(vertices[faces[i].b], vertices[faces[i].a]);
+        vec3_t vector_ac = vec3_sub(vertices[faces[i].c], vertices[faces[i].a]);
+
+        // Same winding as get_triangle_normal, so the normal points towards the visible side of the face
+        vec3_t normal = vec3_cross(vector_ab, vector_ac);
+        float length = vec3_length(normal);
+        if (length > 0) normal = vec3_div(normal, length);
+
+        planes[i] = (vec4_t){normal.x, normal.y, normal.z, vec3_dot(normal, vertices[faces[i].a])};
+    }
+
+    return planes;
+}
+
+void build_mesh_lods(mesh_t* mesh) {
+    mesh->lod_faces[0] = mesh->faces;
+    mesh->num_lods = 1;
+
+    // Simplify each level from the previous one until it stops getting meaningfully smaller
+    while (mesh->num_lods < MAX_NUM_LODS) {
+        face_t* previous_faces = mesh->lod_faces[mesh->num_lods - 1];
+        int previous_num_faces = array_length(previous_faces);
+        int target_num_faces = previous_num_faces * LOD_FACE_RATIO;
+
+        if (target_num_faces < LOD_MIN_NUM_FACES) {
+            break;
+        }
+
+        face_t* simplified_faces = simplify_mesh_faces(mesh->vertices, previous_faces, target_num_faces);
+
+        if (array_length(simplified_faces) == 0 || array_length(simplified_faces) > previous_num_faces * 0.9) {
+            array_free(simplified_faces);
+            break;
         }
+
+        mesh->lod_faces[mesh->num_lods] = simplified_faces;
+        mesh->num_lods++;
+    }
+
+    // Partition every level into clusters that can be culled as a whole
+    for (int lod = 0; lod < mesh->num_lods; lod++) {
+        mesh->lod_meshlets[lod] = build_meshlets(mesh->vertices, mesh->lod_faces[lod]);
+        mesh->lod_num_faces[lod] = array_length(mesh->lod_faces[lod]);
+    }
+
+    // Compute face normals once, after clustering has settled the face order
+    for (int lod = 0; lod < mesh->num_lods; lod++) {
+        mesh->lod_face_planes[lod] = compute_face_planes(mesh->vertices, mesh->lod_faces[lod]);
+    }
+}
+
+int select_mesh_lod(mesh_t* mesh, float screen_radius) {
+    // Roughly half of the faces face the camera and share the projected area of the bounding sphere
+    float screen_area = 3.14159265 * screen_radius * screen_radius;
+    int lod = 0;
+
+    // Drop to coarser levels while the visible faces of the current one would be too small
+    while (lod < mesh->num_lods - 1 && screen_area / (mesh->lod_num_faces[lod] * 0.5) < LOD_MIN_FACE_AREA) {
+        lod++;
+    }
+
+    return lod;
+}
+
+void quantize_mesh_geometry(mesh_t* mesh) {
+    // All levels of detail share one texture coordinate range so they stay consistent
+    get_tex_coord_range(mesh->faces, &mesh->uv_min, &mesh->uv_step);
+
+    for (int lod = 0; lod < mesh->num_lods; lod++) {
+        mesh->lod_quantized_faces[lod] = quantize_faces(mesh->lod_faces[lod], mesh->uv_min, mesh->uv_step);
+        array_free(mesh->lod_faces[lod]);
+        mesh->lod_faces[lod] = NULL;
+    }
+    mesh->faces = NULL;
+
+    mesh->num_vertices = array_length(mesh->vertices);
+    mesh->quantized_vertices = quantize_vertices(mesh->vertices, &mesh->quantize_min, &mesh->quantize_step);
+    array_free(mesh->vertices);
+    mesh->vertices = NULL;
+}
+
+void split_mesh_vertices(mesh_t* mesh) {
+    mesh->num_vertices = array_length(mesh->vertices);
+
+    mesh->soa_vertices.x = (float*)malloc(sizeof(float) * mesh->num_vertices);
+    mesh->soa_vertices.y = (float*)malloc(sizeof(float) * mesh->num_vertices);
+    mesh->soa_vertices.z = (float*)malloc(sizeof(float) * mesh->num_vertices);
+    for (int i = 0; i < mesh->num_vertices; i++) {
+        mesh->soa_vertices.x[i] = mesh->vertices[i].x;
+        mesh->soa_vertices.y[i] = mesh->vertices[i].y;
+        mesh->soa_vertices.z[i] = mesh->vertices[i].z;
+    }
+
+    array_free(mesh->vertices);
+    mesh->vertices = NULL;
+}
+
+void transform_mesh_vertices(mesh_t* mesh, mat4_t* matrix, vec3_soa_t result) {
+    if (mesh->quantized_vertices.x != NULL) {
+        // Fold the dequantization scale and offset into the matrix
+        vec3_t min = mesh->quantize_min;
+        vec3_t step = mesh->quantize_step;
+        mat4_t dequantize_matrix = mat4_mul_mat4(mat4_make_translation(min.x, min.y, min.z), mat4_make_scale(step.x, step.y, step.z));
+        mat4_t combined_matrix = mat4_mul_mat4(*matrix, dequantize_matrix);
+
+        transform_quantized_vertices(&combined_matrix, mesh->quantized_vertices, result, mesh->num_vertices);
+    } else {
+        transform_vertices(matrix, mesh->soa_vertices, result, mesh->num_vertices);
     }
 }
 
+vec3_t get_mesh_vertex(mesh_t* mesh, int index) {
+    if (mesh->quantized_vertices.x != NULL) {
+        return dequantize_vertex(mesh->quantized_vertices, index, mesh->quantize_min, mesh->quantize_step);
+    }
+    return vec3_new(mesh->soa_vertices.x[index], mesh->soa_vertices.y[index], mesh->soa_vertices.z[index]);
+}
+
+face_t get_mesh_face(mesh_t* mesh, int lod, int index) {
+    if (mesh->lod_quantized_faces[lod] != NULL) {
+        return dequantize_face(mesh->lod_quantized_faces[lod][index], mesh->uv_min, mesh->uv_step);
+    }
+    return mesh->lod_faces[lod][index];
+}
+
 int get_num_meshes(void) {
-    return mesh_count;
+    return array_length(meshes);
 }
 
 mesh_t* get_mesh(int index) {
-    return &meshes[index];
+    return meshes[index];
+}
+
+void free_mesh_geometry(mesh_t* geometry) {
+    array_free(geometry->faces);
+    for (int lod = 0; lod < geometry->num_lods; lod++) {
+        if (lod > 0) array_free(geometry->lod_faces[lod]);
+        array_free(geometry->lod_meshlets[lod]);
+        free(geometry->lod_face_planes[lod]);
+        array_free(geometry->lod_quantized_faces[lod]);
+    }
+    array_free(geometry->vertices);
+    free(geometry->soa_vertices.x);
+    free(geometry->soa_vertices.y);
+    free(geometry->soa_vertices.z);
+    free(geometry->quantized_vertices.x);
+    free(geometry->quantized_vertices.y);
+    free(geometry->quantized_vertices.z);
+    free(geometry);
 }
 
 void free_meshes(void) {
-    for (int i = 0; i < mesh_count; i++) {
-        upng_free(meshes[i].texture);
-        array_free(meshes[i].faces);
-        array_free(meshes[i].vertices);
+    for (int i = 0; i < array_length(meshes); i++) {
+        release_mesh_texture(meshes[i]->texture);
+        release_mesh_geometry(meshes[i]->geometry);
+        free(meshes[i]);
     }
+
+    array_free(meshes);
+    meshes = NULL;
+
+    free_asset_cache(&geometry_cache);
+    free_asset_cache(&texture_cache);
 }
\ No newline at end of file
@@ -4,23 +4,82 @@
 #include "vector.h"
 #include "triangle.h"
 #include "upng.h"
+#include "meshlet.h"
+#include "quantize.h"
+#include "matrix.h"
 
-typedef struct {
-    vec3_t* vertices;   // mesh dynamic array of vertices
-    face_t* faces;      // mesh dynamic array of faces
-    upng_t* texture;    // mesh PNG texture pointer
-    vec3_t rotation;    // mesh rotation with x, y and z values
-    vec3_t scale;       // mesh scale with x, y and z values
-    vec3_t translation; // mesh translation with x, y and z values
+#define MAX_NUM_LODS 4
+
+// Each level of detail keeps roughly this fraction of the faces of the previous one
+#define LOD_FACE_RATIO 0.5
+
+// Levels of detail are not simplified below this number of faces
+#define LOD_MIN_NUM_FACES 32
+
+// Average screen area (in pixels) a visible face should cover before a coarser level is used
+#define LOD_MIN_FACE_AREA 8.0
+
+typedef struct mesh {
+    vec3_t* vertices;                               // mesh dynamic array of vertices (replaced by separate arrays after load)
+    vec3_soa_t soa_vertices;                        // vertices as separate x, y and z arrays when not quantized
+    int num_vertices;                               // number of vertices
+    face_t* faces;                                  // mesh dynamic array of faces
+    face_t* lod_faces[MAX_NUM_LODS];                // mesh dynamic arrays of faces per level of detail (level 0 is faces)
+    meshlet_t* lod_meshlets[MAX_NUM_LODS];          // mesh dynamic arrays of face clusters per level of detail
+    vec4_t* lod_face_planes[MAX_NUM_LODS];          // unit face normals (x, y, z) and plane distances (w) in object space per level of detail
+    int lod_num_faces[MAX_NUM_LODS];                // number of faces per level of detail
+    int num_lods;                                   // number of levels of detail built at load
+    qvec3_soa_t quantized_vertices;                 // 16-bit vertices as separate x, y and z arrays when quantized
+    qface_t* lod_quantized_faces[MAX_NUM_LODS];     // faces with 16-bit texture coordinates when quantized
+    vec3_t quantize_min;                            // object space position of quantized vertex (0, 0, 0)
+    vec3_t quantize_step;                           // object space size of one quantized vertex step
+    tex2_t uv_min;                                  // texture coordinate of quantized coordinate (0, 0)
+    tex2_t uv_step;                                 // size of one quantized texture coordinate step
+    vec3_t bounds_min;                              // mesh bounding box minimum corner in object space
+    vec3_t bounds_max;                              // mesh bounding box maximum corner in object space
+    vec3_t bounds_center;                           // mesh bounding sphere center in object space
+    float bounds_radius;                            // mesh bounding sphere radius in object space
+    upng_t* texture;                                // mesh PNG texture pointer
+    struct mesh* geometry;                          // cached mesh whose geometry arrays this mesh shares
 } mesh_t;
 
-void load_mesh(char* obj_filename, char* png_filename, vec3_t scale, vec3_t translation, vec3_t rotation);
+enum mesh_optimize_method {
+    MESH_OPTIMIZE_NONE,
+    MESH_OPTIMIZE_VERTEX_CACHE
+};
+
+enum mesh_storage_method {
+    MESH_STORAGE_FLOAT,
+    MESH_STORAGE_QUANTIZED
+};
+
+void set_mesh_optimize_method(int method);
+void set_mesh_storage_method(int method);
+
+mesh_t* load_mesh(char* obj_filename, char* png_filename);
+mesh_t* load_mesh_geometry(char* obj_filename);
+mesh_t* add_mesh(mesh_t* geometry, upng_t* texture);
+mesh_t* acquire_mesh_geometry(char* obj_filename);
+upng_t* acquire_mesh_texture(char* png_filename);
+mesh_t* cache_mesh_geometry(char* obj_filename, mesh_t* geometry);
+upng_t* cache_mesh_texture(char* png_filename, upng_t* texture);
+void release_mesh_geometry(mesh_t* geometry);
+void release_mesh_texture(upng_t* texture);
 void load_mesh_obj_data(mesh_t* mesh, char* obj_filename);
 void load_mesh_png_data(mesh_t* mesh, char* png_filename);
+void compute_mesh_bounds(mesh_t* mesh);
+void build_mesh_lods(mesh_t* mesh);
+int select_mesh_lod(mesh_t* mesh, float screen_radius);
+void quantize_mesh_geometry(mesh_t* mesh);
+void split_mesh_vertices(mesh_t* mesh);
+void transform_mesh_vertices(mesh_t* mesh, mat4_t* matrix, vec3_soa_t result);
+vec3_t get_mesh_vertex(mesh_t* mesh, int index);
+face_t get_mesh_face(mesh_t* mesh, int lod, int index);
 
 int get_num_meshes(void);
 mesh_t* get_mesh(int index);
 
+void free_mesh_geometry(mesh_t* geometry);
 void free_meshes(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "meshlet.h"
+#include <stdlib.h>
+#include <math.h>
+#include "array.h"
+
+static vec3_t get_face_normal(vec3_t* vertices, face_t face) {
+    vec3_t vector_ab = vec3_sub(vertices[face.b], vertices[face.a]);
+    vec3_t vector_ac = vec3_sub(vertices[face.c], vertices[face.a]);
+
+    vec3_t normal = vec3_cross(vector_ab, vector_ac);
+    float length = vec3_length(normal);
+
+    return length > 0 ? vec3_div(normal, length) : normal;
+}
+
+static void compute_meshlet_bounds(meshlet_t* meshlet, vec3_t* vertices, face_t* faces) {
+    face_t first_face = faces[meshlet->first_face];
+    vec3_t min = vertices[first_face.a];
+    vec3_t max = vertices[first_face.a];
+
+    // Center the bounding sphere on the bounding box of the cluster
+    for (int i = meshlet->first_face; i < meshlet->first_face + meshlet->num_faces; i++) {
+        int corners[3] = {faces[i].a, faces[i].b, faces[i].c};
+
+        for (int j = 0; j < 3; j++) {
+            vec3_t v = vertices[corners[j]];
+            min = vec3_new(fmin(min.x, v.x), fmin(min.y, v.y), fmin(min.z, v.z));
+            max = vec3_new(fmax(max.x, v.x), fmax(max.y, v.y), fmax(max.z, v.z));
+        }
+    }
+
+    meshlet->center = vec3_mul(vec3_add(min, max), 0.5);
+    meshlet->radius = 0;
+
+    for (int i = meshlet->first_face; i < meshlet->first_face + meshlet->num_faces; i++) {
+        int corners[3] = {faces[i].a, faces[i].b, faces[i].c};
+
+        for (int j = 0; j < 3; j++) {
+            float distance = vec3_length(vec3_sub(vertices[corners[j]], meshlet->center));
+            if (distance > meshlet->radius) {
+                meshlet->radius = distance;
+            }
+        }
+    }
+
+    // Find the normal cone of the cluster from the average face normal
+    vec3_t normal_sum = vec3_new(0, 0, 0);
+    for (int i = meshlet->first_face; i < meshlet->first_face + meshlet->num_faces; i++) {
+        normal_sum = vec3_add(normal_sum, get_face_normal(vertices, faces[i]));
+    }
+
+    float length = vec3_length(normal_sum);
+    float min_dot = -1;
+
+    if (length > 0) {
+        meshlet->cone_axis = vec3_div(normal_sum, length);
+        min_dot = 1;
+
+        for (int i = meshlet->first_face; i < meshlet->first_face + meshlet->num_faces; i++) {
+            float dot = vec3_dot(get_face_normal(vertices, faces[i]), meshlet->cone_axis);
+            if (dot < min_dot) {
+                min_dot = dot;
+            }
+        }
+    } else {
+        meshlet->cone_axis = vec3_new(0, 0, 1);
+    }
+
+    // Faces spread over more than a hemisphere can never be culled together, so open the cone to 90 degrees
+    if (min_dot <= 0) {
+        meshlet->cone_cos = 0;
+        meshlet->cone_sin = 1;
+    } else {
+        meshlet->cone_cos = min_dot;
+        meshlet->cone_sin = sqrt(1 - min_dot * min_dot);
+    }
+}
+
+meshlet_t* build_meshlets(vec3_t* vertices, face_t* faces) {
+    meshlet_t* meshlets = NULL;
+    int num_faces = array_length(faces);
+    int num_vertices = array_length(vertices);
+
+    if (num_faces == 0) {
+        return NULL;
+    }
+
+    // Build the vertex to face adjacency list
+    int* adjacency_offset = (int*)calloc(num_vertices + 1, sizeof(int));
+    int* adjacency = (int*)malloc(sizeof(int) * num_faces * 3);
+    for (int i = 0; i < num_faces; i++) {
+        adjacency_offset[faces[i].a + 1]++;
+        adjacency_offset[faces[i].b + 1]++;
+        adjacency_offset[faces[i].c + 1]++;
+    }
+    for (int i = 0; i < num_vertices; i++) {
+        adjacency_offset[i + 1] += adjacency_offset[i];
+    }
+
+    int* adjacency_fill = (int*)calloc(num_vertices, sizeof(int));
+    for (int i = 0; i < num_faces; i++) {
+        int corners[3] = {faces[i].a, faces[i].b, faces[i].c};
+        for (int j = 0; j < 3; j++) {
+            adjacency[adjacency_offset[corners[j]] + adjacency_fill[corners[j]]++] = i;
+        }
+    }
+
+    vec3_t* normals = (vec3_t*)malloc(sizeof(vec3_t) * num_faces);
+    for (int i = 0; i < num_faces; i++) {
+        normals[i] = get_face_normal(vertices, faces[i]);
+    }
+
+    char* assigned = (char*)calloc(num_faces, sizeof(char));
+    char* is_candidate = (char*)calloc(num_faces, sizeof(char));
+    int* candidates = (int*)malloc(sizeof(int) * num_faces);
+    face_t* clustered_faces = (face_t*)malloc(sizeof(face_t) * num_faces);
+    int num_clustered_faces = 0;
+
+    // Grow each cluster from the first unassigned face (in locality order) across shared vertices
+    for (int seed = 0; seed < num_faces; seed++) {
+        if (assigned[seed]) continue;
+
+        meshlet_t meshlet = {.first_face = num_clustered_faces, .num_faces = 0};
+        vec3_t normal_sum = vec3_new(0, 0, 0);
+        int num_candidates = 0;
+        int next_face = seed;
+
+        while (next_face >= 0) {
+            face_t face = faces[next_face];
+            int corners[3] = {face.a, face.b, face.c};
+
+            assigned[next_face] = 1;
+            clustered_faces[num_clustered_faces++] = face;
+            normal_sum = vec3_add(normal_sum, normals[next_face]);
+            meshlet.num_faces++;
+
+            if (meshlet.num_faces >= MAX_MESHLET_FACES) break;
+
+            // Faces sharing a vertex with the new face become candidates
+            for (int j = 0; j < 3; j++) {
+                for (int k = adjacency_offset[corners[j]]; k < adjacency_offset[corners[j] + 1]; k++) {
+                    int neighbor = adjacency[k];
+                    if (!assigned[neighbor] && !is_candidate[neighbor]) {
+                        is_candidate[neighbor] = 1;
+                        candidates[num_candidates++] = neighbor;
+                    }
+                }
+            }
+
+            // Pick the candidate closest to the cluster orientation
+            vec3_t axis = normal_sum;
+            float length = vec3_length(axis);
+            if (length > 0) axis = vec3_div(axis, length);
+
+            float best_dot = meshlet.num_faces < MIN_MESHLET_FACES ? -2 : MESHLET_NORMAL_DOT;
+            int best_index = -1;
+            for (int c = 0; c < num_candidates; c++) {
+                float dot = vec3_dot(normals[candidates[c]], axis);
+                if (dot >= best_dot) {
+                    best_dot = dot;
+                    best_index = c;
+                }
+            }
+
+            next_face = -1;
+            if (best_index >= 0) {
+                next_face = candidates[best_index];
+                candidates[best_index] = candidates[--num_candidates];
+                is_candidate[next_face] = 0;
+            }
+        }
+
+        for (int c = 0; c < num_candidates; c++) {
+            is_candidate[candidates[c]] = 0;
+        }
+
+        array_push(meshlets, meshlet);
+    }
+
+    // Store faces grouped by cluster so each cluster is a contiguous range
+    for (int i = 0; i < num_faces; i++) {
+        faces[i] = clustered_faces[i];
+    }
+
+    int num_meshlets = array_length(meshlets);
+    for (int i = 0; i < num_meshlets; i++) {
+        compute_meshlet_bounds(&meshlets[i], vertices, faces);
+    }
+
+    free(adjacency_offset);
+    free(adjacency);
+    free(adjacency_fill);
+    free(normals);
+    free(assigned);
+    free(is_candidate);
+    free(candidates);
+    free(clustered_faces);
+
+    return meshlets;
+}
+
+bool is_meshlet_backfacing(meshlet_t* meshlet, vec3_t center, vec3_t cone_axis, float radius) {
+    // Camera sits at the origin, so the center is also the view ray towards the cluster.
+    // Every face points away from the camera if the cone axis plus its spread stays
+    // more than the bounding radius away from the view ray: |c| cos(angle + spread) > r
+    float center_dot_axis = vec3_dot(center, cone_axis);
+    float center_length_squared = vec3_dot(center, center);
+    float perpendicular = sqrt(fmax(center_length_squared - center_dot_axis * center_dot_axis, 0));
+
+    return center_dot_axis * meshlet->cone_cos - perpendicular * meshlet->cone_sin > radius;
+}
@@ -0,0 +1,30 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <stdbool.h>
+#include "vector.h"
+#include "triangle.h"
+
+// Maximum number of faces in a cluster
+#define MAX_MESHLET_FACES 96
+
+// Clusters accept neighbors of any orientation until they reach this number of faces
+#define MIN_MESHLET_FACES 16
+
+// Past the minimum size a face only joins a cluster if its normal is within this cosine of the cluster normal
+#define MESHLET_NORMAL_DOT 0.7
+
+typedef struct {
+    int first_face;     // index of the first face of the cluster in the face array
+    int num_faces;      // number of consecutive faces in the cluster
+    vec3_t center;      // bounding sphere center in object space
+    float radius;       // bounding sphere radius in object space
+    vec3_t cone_axis;   // average normal of the cluster faces
+    float cone_cos;     // cosine of the largest angle between a face normal and the cone axis
+    float cone_sin;     // sine of the largest angle between a face normal and the cone axis
+} meshlet_t;
+
+meshlet_t* build_meshlets(vec3_t* vertices, face_t* faces);
+bool is_meshlet_backfacing(meshlet_t* meshlet, vec3_t center, vec3_t cone_axis, float radius);
+
+#endif
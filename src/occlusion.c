@@ -0,0 +1,204 @@
+#include "occlusion.h"
+#include <math.h>
+#include "display.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OCCLUSION_NEON
+#endif
+
+// Low resolution buffer of the nearest occluder depth per pixel, stored as 1/w so larger is nearer
+static float occlusion_buffer[OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT];
+
+static int occlusion_method = OCCLUSION_NONE;
+static int num_occluder_triangles = 0;
+
+void set_occlusion_method(int method) {
+    occlusion_method = method;
+}
+
+bool is_occlusion_culling(void) {
+    return occlusion_method == OCCLUSION_DEPTH_BUFFER;
+}
+
+void clear_occlusion_buffer(void) {
+    for (int i = 0; i < OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT; i++) {
+        occlusion_buffer[i] = 0;
+    }
+    num_occluder_triangles = 0;
+}
+
+static void rasterize_occluder_row(float* row, int x_start, int x_end, float e0, float e1, float e2,
+                                   float e0_dx, float e1_dx, float e2_dx, float depth, float depth_dx) {
+    int x = x_start;
+
+#if defined(OCCLUSION_SSE2)
+    // Process 4 pixels at a time, keeping the nearest depth where all edge functions are inside
+    __m128 steps = _mm_set_ps(3, 2, 1, 0);
+    __m128 zero = _mm_setzero_ps();
+    for (; x + 4 <= x_end; x += 4) {
+        float offset = x - x_start;
+        __m128 w0 = _mm_add_ps(_mm_set1_ps(e0 + e0_dx * offset), _mm_mul_ps(steps, _mm_set1_ps(e0_dx)));
+        __m128 w1 = _mm_add_ps(_mm_set1_ps(e1 + e1_dx * offset), _mm_mul_ps(steps, _mm_set1_ps(e1_dx)));
+        __m128 w2 = _mm_add_ps(_mm_set1_ps(e2 + e2_dx * offset), _mm_mul_ps(steps, _mm_set1_ps(e2_dx)));
+        __m128 z = _mm_add_ps(_mm_set1_ps(depth + depth_dx * offset), _mm_mul_ps(steps, _mm_set1_ps(depth_dx)));
+
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_and_ps(_mm_cmpge_ps(w1, zero), _mm_cmpge_ps(w2, zero)));
+        __m128 current = _mm_loadu_ps(&row[x]);
+        __m128 nearest = _mm_max_ps(current, z);
+        _mm_storeu_ps(&row[x], _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+    }
+#elif defined(OCCLUSION_NEON)
+    float step_values[4] = {0, 1, 2, 3};
+    float32x4_t steps = vld1q_f32(step_values);
+    float32x4_t zero = vdupq_n_f32(0);
+    for (; x + 4 <= x_end; x += 4) {
+        float offset = x - x_start;
+        float32x4_t w0 = vmlaq_n_f32(vdupq_n_f32(e0 + e0_dx * offset), steps, e0_dx);
+        float32x4_t w1 = vmlaq_n_f32(vdupq_n_f32(e1 + e1_dx * offset), steps, e1_dx);
+        float32x4_t w2 = vmlaq_n_f32(vdupq_n_f32(e2 + e2_dx * offset), steps, e2_dx);
+        float32x4_t z = vmlaq_n_f32(vdupq_n_f32(depth + depth_dx * offset), steps, depth_dx);
+
+        uint32x4_t inside = vandq_u32(vcgeq_f32(w0, zero), vandq_u32(vcgeq_f32(w1, zero), vcgeq_f32(w2, zero)));
+        float32x4_t current = vld1q_f32(&row[x]);
+        vst1q_f32(&row[x], vbslq_f32(inside, vmaxq_f32(current, z), current));
+    }
+#endif
+
+    // Remaining pixels one at a time
+    for (; x < x_end; x++) {
+        float offset = x - x_start;
+        if (e0 + e0_dx * offset >= 0 && e1 + e1_dx * offset >= 0 && e2 + e2_dx * offset >= 0) {
+            float z = depth + depth_dx * offset;
+            if (z > row[x]) {
+                row[x] = z;
+            }
+        }
+    }
+}
+
+static void rasterize_occluder(triangle_t* triangle) {
+    float scale_x = (float)OCCLUSION_BUFFER_WIDTH / get_window_width();
+    float scale_y = (float)OCCLUSION_BUFFER_HEIGHT / get_window_height();
+
+    // Move the triangle points into occlusion buffer pixels
+    vec2_t p[3];
+    float inv_w[3];
+    for (int i = 0; i < 3; i++) {
+        p[i] = vec2_new(triangle->points[i].x * scale_x, triangle->points[i].y * scale_y);
+        inv_w[i] = 1.0 / triangle->points[i].w;
+    }
+
+    float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    if (fabs(area) < 1e-6) {
+        return;
+    }
+
+    // Accept both windings by flipping the sign of the edge functions for negative areas
+    float sign = area > 0 ? 1 : -1;
+    area *= sign;
+
+    int x_min = fmax(floor(fmin(p[0].x, fmin(p[1].x, p[2].x))), 0);
+    int x_max = fmin(ceil(fmax(p[0].x, fmax(p[1].x, p[2].x))), OCCLUSION_BUFFER_WIDTH);
+    int y_min = fmax(floor(fmin(p[0].y, fmin(p[1].y, p[2].y))), 0);
+    int y_max = fmin(ceil(fmax(p[0].y, fmax(p[1].y, p[2].y))), OCCLUSION_BUFFER_HEIGHT);
+
+    // Edge function i is positive on the inside of the edge opposite to vertex i
+    float e_dx[3], e_dy[3], e_origin[3];
+    for (int i = 0; i < 3; i++) {
+        vec2_t a = p[(i + 1) % 3];
+        vec2_t b = p[(i + 2) % 3];
+        e_dx[i] = sign * (a.y - b.y);
+        e_dy[i] = sign * (b.x - a.x);
+        e_origin[i] = sign * (a.x * b.y - a.y * b.x);
+    }
+
+    // 1/w is linear in screen space, so interpolate it with the normalized edge functions
+    float depth_dx = (e_dx[0] * inv_w[0] + e_dx[1] * inv_w[1] + e_dx[2] * inv_w[2]) / area;
+    float depth_dy = (e_dy[0] * inv_w[0] + e_dy[1] * inv_w[1] + e_dy[2] * inv_w[2]) / area;
+    float depth_origin = (e_origin[0] * inv_w[0] + e_origin[1] * inv_w[1] + e_origin[2] * inv_w[2]) / area;
+
+    // Rasterize conservatively: move each edge in by half a pixel so only pixels with all 4 corners inside
+    // are written, and store the farthest depth of the pixel corners instead of the one at the center
+    for (int i = 0; i < 3; i++) {
+        e_origin[i] -= 0.5 * (fabs(e_dx[i]) + fabs(e_dy[i]));
+    }
+    depth_origin -= 0.5 * (fabs(depth_dx) + fabs(depth_dy));
+
+    for (int y = y_min; y < y_max; y++) {
+        // Evaluate at pixel centers, the offsets above make that cover the whole pixel
+        float px = x_min + 0.5;
+        float py = y + 0.5;
+
+        rasterize_occluder_row(
+            &occlusion_buffer[y * OCCLUSION_BUFFER_WIDTH], x_min, x_max,
+            e_origin[0] + e_dx[0] * px + e_dy[0] * py,
+            e_origin[1] + e_dx[1] * px + e_dy[1] * py,
+            e_origin[2] + e_dx[2] * px + e_dy[2] * py,
+            e_dx[0], e_dx[1], e_dx[2],
+            depth_origin + depth_dx * px + depth_dy * py, depth_dx
+        );
+    }
+}
+
+void rasterize_occluders(triangle_t* triangles, int num_triangles) {
+    for (int i = 0; i < num_triangles && num_occluder_triangles < MAX_OCCLUDER_TRIANGLES; i++) {
+        rasterize_occluder(&triangles[i]);
+        num_occluder_triangles++;
+    }
+}
+
+bool is_box_occluded(vec3_t min, vec3_t max, mat4_t view_matrix, mat4_t proj_matrix) {
+    float x_min = OCCLUSION_BUFFER_WIDTH, x_max = 0;
+    float y_min = OCCLUSION_BUFFER_HEIGHT, y_max = 0;
+    float nearest_depth = 0;
+
+    // Find the screen rectangle and nearest depth of the box corners
+    for (int i = 0; i < 8; i++) {
+        vec4_t corner = {
+            (i & 1) ? max.x : min.x,
+            (i & 2) ? max.y : min.y,
+            (i & 4) ? max.z : min.z,
+            1
+        };
+        corner = mat4_mul_vec4(view_matrix, corner);
+
+        // Boxes reaching behind the camera cannot be projected, so treat them as visible
+        if (corner.z <= 0) {
+            return false;
+        }
+
+        vec4_t projected = mat4_mul_vec4_project(proj_matrix, corner);
+        float x = (projected.x + 1) * 0.5 * OCCLUSION_BUFFER_WIDTH;
+        float y = (1 - projected.y) * 0.5 * OCCLUSION_BUFFER_HEIGHT;
+
+        x_min = fmin(x_min, x);
+        x_max = fmax(x_max, x);
+        y_min = fmin(y_min, y);
+        y_max = fmax(y_max, y);
+        nearest_depth = fmax(nearest_depth, 1.0 / corner.z);
+    }
+
+    int x_start = fmax(floor(x_min), 0);
+    int x_end = fmin(ceil(x_max), OCCLUSION_BUFFER_WIDTH);
+    int y_start = fmax(floor(y_min), 0);
+    int y_end = fmin(ceil(y_max), OCCLUSION_BUFFER_HEIGHT);
+
+    if (x_start >= x_end || y_start >= y_end) {
+        return false;
+    }
+
+    // The box is hidden only if an occluder is nearer than its nearest corner everywhere it covers
+    for (int y = y_start; y < y_end; y++) {
+        for (int x = x_start; x < x_end; x++) {
+            if (occlusion_buffer[y * OCCLUSION_BUFFER_WIDTH + x] <= nearest_depth) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef OCCLUSION_H
+#define OCCLUSION_H
+
+#include <stdbool.h>
+#include "vector.h"
+#include "matrix.h"
+#include "triangle.h"
+
+#define OCCLUSION_BUFFER_WIDTH 256
+#define OCCLUSION_BUFFER_HEIGHT 144
+
+// Instances covering at least this screen radius (in pixels) are drawn into the occlusion buffer
+#define OCCLUDER_MIN_SCREEN_RADIUS 32.0
+
+// Maximum number of occluder triangles drawn into the occlusion buffer per frame
+#define MAX_OCCLUDER_TRIANGLES 8192
+
+enum occlusion_method {
+    OCCLUSION_NONE,
+    OCCLUSION_DEPTH_BUFFER
+};
+
+void set_occlusion_method(int method);
+bool is_occlusion_culling(void);
+
+void clear_occlusion_buffer(void);
+void rasterize_occluders(triangle_t* triangles, int num_triangles);
+bool is_box_occluded(vec3_t min, vec3_t max, mat4_t view_matrix, mat4_t proj_matrix);
+
+#endif
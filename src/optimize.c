@@ -0,0 +1,203 @@
+#include "optimize.h"
+#include <stdlib.h>
+#include "array.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Face reordering based on the Tipsify algorithm (Sander, Nehab, Barczak 2007)
+///////////////////////////////////////////////////////////////////////////////
+
+static int skip_dead_end(int* live_count, int* dead_end, int* num_dead_end, int num_vertices, int* cursor) {
+    // Look for a recently used vertex that still has faces left
+    while (*num_dead_end > 0) {
+        int vertex = dead_end[--(*num_dead_end)];
+
+        if (live_count[vertex] > 0) {
+            return vertex;
+        }
+    }
+
+    // Otherwise continue with the next vertex in input order that still has faces left
+    while (*cursor < num_vertices) {
+        if (live_count[*cursor] > 0) {
+            return *cursor;
+        }
+        (*cursor)++;
+    }
+
+    return -1;
+}
+
+static int get_next_vertex(int* candidates, int num_candidates, int* live_count, int* time_stamp, int time, int cache_size,
+                           int* dead_end, int* num_dead_end, int num_vertices, int* cursor) {
+    int best_vertex = -1;
+    int best_priority = -1;
+
+    // Pick the candidate that will still be in the cache after all its remaining faces are emitted
+    for (int i = 0; i < num_candidates; i++) {
+        int vertex = candidates[i];
+
+        if (live_count[vertex] > 0) {
+            int priority = 0;
+
+            if (time - time_stamp[vertex] + 2 * live_count[vertex] <= cache_size) {
+                priority = time - time_stamp[vertex];
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                best_vertex = vertex;
+            }
+        }
+    }
+
+    if (best_vertex == -1) {
+        best_vertex = skip_dead_end(live_count, dead_end, num_dead_end, num_vertices, cursor);
+    }
+
+    return best_vertex;
+}
+
+void optimize_mesh_face_order(mesh_t* mesh, int cache_size) {
+    int num_faces = array_length(mesh->faces);
+    int num_vertices = array_length(mesh->vertices);
+
+    if (num_faces == 0 || num_vertices == 0) {
+        return;
+    }
+
+    // Count the faces that use each vertex
+    int* live_count = (int*)calloc(num_vertices, sizeof(int));
+    for (int i = 0; i < num_faces; i++) {
+        live_count[mesh->faces[i].a]++;
+        live_count[mesh->faces[i].b]++;
+        live_count[mesh->faces[i].c]++;
+    }
+
+    // Build the vertex to face adjacency list using a prefix sum of the face counts
+    int* adjacency_offset = (int*)malloc(sizeof(int) * (num_vertices + 1));
+    adjacency_offset[0] = 0;
+    for (int i = 0; i < num_vertices; i++) {
+        adjacency_offset[i + 1] = adjacency_offset[i] + live_count[i];
+    }
+
+    int* adjacency = (int*)malloc(sizeof(int) * num_faces * 3);
+    int* adjacency_fill = (int*)calloc(num_vertices, sizeof(int));
+    for (int i = 0; i < num_faces; i++) {
+        int corners[3] = {mesh->faces[i].a, mesh->faces[i].b, mesh->faces[i].c};
+
+        for (int j = 0; j < 3; j++) {
+            int vertex = corners[j];
+            adjacency[adjacency_offset[vertex] + adjacency_fill[vertex]] = i;
+            adjacency_fill[vertex]++;
+        }
+    }
+
+    int* time_stamp = (int*)calloc(num_vertices, sizeof(int));
+    int* dead_end = (int*)malloc(sizeof(int) * num_faces * 3);
+    int* candidates = (int*)malloc(sizeof(int) * num_faces * 3);
+    char* emitted = (char*)calloc(num_faces, sizeof(char));
+    face_t* reordered_faces = NULL;
+    int num_dead_end = 0;
+
+    int time = cache_size + 1;
+    int cursor = 0;
+    int fanning_vertex = skip_dead_end(live_count, dead_end, &num_dead_end, num_vertices, &cursor);
+
+    while (fanning_vertex >= 0) {
+        int num_candidates = 0;
+
+        // Emit every face around the fanning vertex that has not been emitted yet
+        for (int i = adjacency_offset[fanning_vertex]; i < adjacency_offset[fanning_vertex + 1]; i++) {
+            int face_index = adjacency[i];
+
+            if (emitted[face_index]) {
+                continue;
+            }
+
+            face_t face = mesh->faces[face_index];
+            int corners[3] = {face.a, face.b, face.c};
+
+            for (int j = 0; j < 3; j++) {
+                int vertex = corners[j];
+
+                dead_end[num_dead_end++] = vertex;
+                candidates[num_candidates++] = vertex;
+                live_count[vertex]--;
+
+                // Vertex is no longer in the cache so it gets loaded again
+                if (time - time_stamp[vertex] > cache_size) {
+                    time_stamp[vertex] = time;
+                    time++;
+                }
+            }
+
+            emitted[face_index] = 1;
+            array_push(reordered_faces, face);
+        }
+
+        fanning_vertex = get_next_vertex(
+            candidates, num_candidates, live_count, time_stamp, time, cache_size,
+            dead_end, &num_dead_end, num_vertices, &cursor
+        );
+    }
+
+    // Replace the mesh faces with the reordered ones
+    array_free(mesh->faces);
+    mesh->faces = reordered_faces;
+
+    free(live_count);
+    free(adjacency_offset);
+    free(adjacency);
+    free(adjacency_fill);
+    free(time_stamp);
+    free(dead_end);
+    free(candidates);
+    free(emitted);
+}
+
+void optimize_mesh_vertex_order(mesh_t* mesh) {
+    int num_faces = array_length(mesh->faces);
+    int num_vertices = array_length(mesh->vertices);
+
+    if (num_vertices == 0) {
+        return;
+    }
+
+    // Map each old vertex index to its new index, in order of first use by the faces
+    int* remap = (int*)malloc(sizeof(int) * num_vertices);
+    for (int i = 0; i < num_vertices; i++) {
+        remap[i] = -1;
+    }
+
+    vec3_t* reordered_vertices = NULL;
+    for (int i = 0; i < num_faces; i++) {
+        int* corners[3] = {&mesh->faces[i].a, &mesh->faces[i].b, &mesh->faces[i].c};
+
+        for (int j = 0; j < 3; j++) {
+            int vertex = *corners[j];
+
+            if (remap[vertex] == -1) {
+                remap[vertex] = array_length(reordered_vertices);
+                array_push(reordered_vertices, mesh->vertices[vertex]);
+            }
+            *corners[j] = remap[vertex];
+        }
+    }
+
+    // Keep vertices that are not used by any face at the end
+    for (int i = 0; i < num_vertices; i++) {
+        if (remap[i] == -1) {
+            array_push(reordered_vertices, mesh->vertices[i]);
+        }
+    }
+
+    array_free(mesh->vertices);
+    mesh->vertices = reordered_vertices;
+
+    free(remap);
+}
+
+void optimize_mesh_vertex_cache(mesh_t* mesh) {
+    // Reorder faces so consecutive faces share vertices, then lay vertices out in the order they are used
+    optimize_mesh_face_order(mesh, VERTEX_CACHE_SIZE);
+    optimize_mesh_vertex_order(mesh);
+}
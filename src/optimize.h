@@ -0,0 +1,13 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "mesh.h"
+
+// Number of recently used vertices the face reordering tries to keep "hot"
+#define VERTEX_CACHE_SIZE 16
+
+void optimize_mesh_face_order(mesh_t* mesh, int cache_size);
+void optimize_mesh_vertex_order(mesh_t* mesh);
+void optimize_mesh_vertex_cache(mesh_t* mesh);
+
+#endif
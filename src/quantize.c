@@ -0,0 +1,129 @@
+#include "quantize.h"
+#include <stdlib.h>
+#include <math.h>
+#include "array.h"
+
+static uint16_t quantize_value(float value, float min, float step) {
+    if (step <= 0) {
+        return 0;
+    }
+
+    float quantized = round((value - min) / step);
+    return (uint16_t)fmin(fmax(quantized, 0), QUANTIZE_MAX);
+}
+
+static float get_step(float min, float max) {
+    return (max - min) / QUANTIZE_MAX;
+}
+
+qvec3_soa_t quantize_vertices(vec3_t* vertices, vec3_t* min, vec3_t* step) {
+    int num_vertices = array_length(vertices);
+    qvec3_soa_t quantized_vertices = {NULL, NULL, NULL};
+
+    if (num_vertices == 0) {
+        *min = vec3_new(0, 0, 0);
+        *step = vec3_new(0, 0, 0);
+        return quantized_vertices;
+    }
+
+    // Positions are stored relative to the bounding box of the vertices
+    vec3_t max = vertices[0];
+    *min = vertices[0];
+    for (int i = 1; i < num_vertices; i++) {
+        vec3_t v = vertices[i];
+        *min = vec3_new(fmin(min->x, v.x), fmin(min->y, v.y), fmin(min->z, v.z));
+        max = vec3_new(fmax(max.x, v.x), fmax(max.y, v.y), fmax(max.z, v.z));
+    }
+    *step = vec3_new(get_step(min->x, max.x), get_step(min->y, max.y), get_step(min->z, max.z));
+
+    quantized_vertices.x = (uint16_t*)malloc(sizeof(uint16_t) * num_vertices);
+    quantized_vertices.y = (uint16_t*)malloc(sizeof(uint16_t) * num_vertices);
+    quantized_vertices.z = (uint16_t*)malloc(sizeof(uint16_t) * num_vertices);
+    for (int i = 0; i < num_vertices; i++) {
+        quantized_vertices.x[i] = quantize_value(vertices[i].x, min->x, step->x);
+        quantized_vertices.y[i] = quantize_value(vertices[i].y, min->y, step->y);
+        quantized_vertices.z[i] = quantize_value(vertices[i].z, min->z, step->z);
+    }
+
+    return quantized_vertices;
+}
+
+void get_tex_coord_range(face_t* faces, tex2_t* uv_min, tex2_t* uv_step) {
+    int num_faces = array_length(faces);
+
+    if (num_faces == 0) {
+        *uv_min = (tex2_t){0, 0};
+        *uv_step = (tex2_t){0, 0};
+        return;
+    }
+
+    // Texture coordinates are usually within 0 to 1 but may repeat the texture, so use their actual range
+    tex2_t max = faces[0].a_uv;
+    *uv_min = faces[0].a_uv;
+    for (int i = 0; i < num_faces; i++) {
+        tex2_t corners[3] = {faces[i].a_uv, faces[i].b_uv, faces[i].c_uv};
+
+        for (int j = 0; j < 3; j++) {
+            uv_min->u = fmin(uv_min->u, corners[j].u);
+            uv_min->v = fmin(uv_min->v, corners[j].v);
+            max.u = fmax(max.u, corners[j].u);
+            max.v = fmax(max.v, corners[j].v);
+        }
+    }
+
+    uv_step->u = get_step(uv_min->u, max.u);
+    uv_step->v = get_step(uv_min->v, max.v);
+}
+
+qface_t* quantize_faces(face_t* faces, tex2_t uv_min, tex2_t uv_step) {
+    int num_faces = array_length(faces);
+
+    if (num_faces == 0) {
+        return NULL;
+    }
+
+    qface_t* quantized_faces = array_hold(NULL, num_faces, sizeof(qface_t));
+    for (int i = 0; i < num_faces; i++) {
+        tex2_t corners[3] = {faces[i].a_uv, faces[i].b_uv, faces[i].c_uv};
+        qtex2_t quantized_corners[3];
+
+        for (int j = 0; j < 3; j++) {
+            quantized_corners[j].u = quantize_value(corners[j].u, uv_min.u, uv_step.u);
+            quantized_corners[j].v = quantize_value(corners[j].v, uv_min.v, uv_step.v);
+        }
+
+        quantized_faces[i] = (qface_t){
+            .a = faces[i].a,
+            .b = faces[i].b,
+            .c = faces[i].c,
+            .a_uv = quantized_corners[0],
+            .b_uv = quantized_corners[1],
+            .c_uv = quantized_corners[2],
+            .color = faces[i].color
+        };
+    }
+
+    return quantized_faces;
+}
+
+vec3_t dequantize_vertex(qvec3_soa_t vertices, int index, vec3_t min, vec3_t step) {
+    vec3_t result = {
+        .x = min.x + vertices.x[index] * step.x,
+        .y = min.y + vertices.y[index] * step.y,
+        .z = min.z + vertices.z[index] * step.z
+    };
+    return result;
+}
+
+face_t dequantize_face(qface_t face, tex2_t uv_min, tex2_t uv_step) {
+    face_t result = {
+        .a = face.a,
+        .b = face.b,
+        .c = face.c,
+        .a_uv = {uv_min.u + face.a_uv.u * uv_step.u, uv_min.v + face.a_uv.v * uv_step.v},
+        .b_uv = {uv_min.u + face.b_uv.u * uv_step.u, uv_min.v + face.b_uv.v * uv_step.v},
+        .c_uv = {uv_min.u + face.c_uv.u * uv_step.u, uv_min.v + face.c_uv.v * uv_step.v},
+        .color = face.color
+    };
+    return result;
+}
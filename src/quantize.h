@@ -0,0 +1,41 @@
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+#include <stdint.h>
+#include "vector.h"
+#include "texture.h"
+#include "triangle.h"
+
+// Largest value of a 16-bit quantized coordinate
+#define QUANTIZE_MAX 65535
+
+// Array of quantized 3D vectors stored as separate x, y and z arrays
+typedef struct {
+    uint16_t* x;
+    uint16_t* y;
+    uint16_t* z;
+} qvec3_soa_t;
+
+typedef struct {
+    uint16_t u;
+    uint16_t v;
+} qtex2_t;
+
+typedef struct {
+    int a;
+    int b;
+    int c;
+    qtex2_t a_uv;
+    qtex2_t b_uv;
+    qtex2_t c_uv;
+    uint32_t color;
+} qface_t;
+
+qvec3_soa_t quantize_vertices(vec3_t* vertices, vec3_t* min, vec3_t* step);
+qface_t* quantize_faces(face_t* faces, tex2_t uv_min, tex2_t uv_step);
+void get_tex_coord_range(face_t* faces, tex2_t* uv_min, tex2_t* uv_step);
+
+vec3_t dequantize_vertex(qvec3_soa_t vertices, int index, vec3_t min, vec3_t step);
+face_t dequantize_face(qface_t face, tex2_t uv_min, tex2_t uv_step);
+
+#endif
@@ -0,0 +1,384 @@
+#include "simplify.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "array.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Quadric error mesh simplification (Garland and Heckbert 1997) using
+// half-edge collapses, so every simplified face still indexes the original
+// vertex array and only the face list needs to be stored per level of detail
+///////////////////////////////////////////////////////////////////////////////
+
+// Faces whose normal turns by more than this (cosine) after a collapse are rejected
+#define MIN_COLLAPSE_NORMAL_DOT 0.2
+
+typedef struct {
+    double q[10]; // upper triangle of the symmetric 4x4 quadric matrix
+} quadric_t;
+
+typedef struct {
+    double cost;
+    int from;
+    int to;
+} collapse_t;
+
+static void quadric_add_plane(quadric_t* quadric, double a, double b, double c, double d, double weight) {
+    double* q = quadric->q;
+
+    q[0] += weight * a * a; q[1] += weight * a * b; q[2] += weight * a * c; q[3] += weight * a * d;
+    q[4] += weight * b * b; q[5] += weight * b * c; q[6] += weight * b * d;
+    q[7] += weight * c * c; q[8] += weight * c * d;
+    q[9] += weight * d * d;
+}
+
+static double quadric_error(quadric_t* a, quadric_t* b, vec3_t v) {
+    double q[10];
+    for (int i = 0; i < 10; i++) {
+        q[i] = a->q[i] + b->q[i];
+    }
+
+    double x = v.x, y = v.y, z = v.z;
+
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+         + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+         + q[7] * z * z + 2 * q[8] * z
+         + q[9];
+}
+
+static int compare_collapses(const void* a, const void* b) {
+    double cost_a = ((const collapse_t*)a)->cost;
+    double cost_b = ((const collapse_t*)b)->cost;
+
+    return (cost_a > cost_b) - (cost_a < cost_b);
+}
+
+static vec3_t* sort_vertices = NULL;
+
+static int compare_vertex_positions(const void* a, const void* b) {
+    vec3_t va = sort_vertices[*(const int*)a];
+    vec3_t vb = sort_vertices[*(const int*)b];
+
+    if (va.x != vb.x) return va.x < vb.x ? -1 : 1;
+    if (va.y != vb.y) return va.y < vb.y ? -1 : 1;
+    if (va.z != vb.z) return va.z < vb.z ? -1 : 1;
+
+    return *(const int*)a - *(const int*)b;
+}
+
+static int* weld_vertex_positions(vec3_t* vertices, int num_vertices) {
+    // OBJ meshes split vertices along UV seams, so map every vertex to the first vertex with the same position
+    int* order = (int*)malloc(sizeof(int) * num_vertices);
+    int* canonical = (int*)malloc(sizeof(int) * num_vertices);
+
+    for (int i = 0; i < num_vertices; i++) {
+        order[i] = i;
+    }
+
+    sort_vertices = vertices;
+    qsort(order, num_vertices, sizeof(int), compare_vertex_positions);
+    sort_vertices = NULL;
+
+    for (int i = 0; i < num_vertices; i++) {
+        vec3_t v = vertices[order[i]];
+
+        if (i > 0 && memcmp(&v, &vertices[order[i - 1]], sizeof(vec3_t)) == 0) {
+            canonical[order[i]] = canonical[order[i - 1]];
+        } else {
+            canonical[order[i]] = order[i];
+        }
+    }
+
+    free(order);
+    return canonical;
+}
+
+static vec3_t face_cross(vec3_t a, vec3_t b, vec3_t c) {
+    return vec3_cross(vec3_sub(b, a), vec3_sub(c, a));
+}
+
+static int* face_corner(face_t* face, int index) {
+    return index == 0 ? &face->a : index == 1 ? &face->b : &face->c;
+}
+
+static tex2_t* face_corner_uv(face_t* face, int index) {
+    return index == 0 ? &face->a_uv : index == 1 ? &face->b_uv : &face->c_uv;
+}
+
+static bool find_collapse_uv(face_t* faces, char* dead, int* adjacency, int begin, int end, int from, int to, tex2_t* uv) {
+    // The moved corners take the UV of the kept vertex, which must be the same on every face around the edge
+    bool has_from_uv = false;
+    bool has_to_uv = false;
+    tex2_t from_uv;
+
+    for (int i = begin; i < end; i++) {
+        face_t* face = &faces[adjacency[i]];
+
+        if (dead[adjacency[i]]) continue;
+
+        for (int j = 0; j < 3; j++) {
+            int corner = *face_corner(face, j);
+            tex2_t corner_uv = *face_corner_uv(face, j);
+
+            // Either vertex lying on a UV seam here would tear or smear the texture on one side of it
+            if (corner == from) {
+                if (has_from_uv && (corner_uv.u != from_uv.u || corner_uv.v != from_uv.v)) return false;
+                from_uv = corner_uv;
+                has_from_uv = true;
+            } else if (corner == to) {
+                if (has_to_uv && (corner_uv.u != uv->u || corner_uv.v != uv->v)) return false;
+                *uv = corner_uv;
+                has_to_uv = true;
+            }
+        }
+    }
+
+    return has_to_uv;
+}
+
+static bool collapse_flips_faces(vec3_t* vertices, face_t* faces, char* dead, int* adjacency, int begin, int end, int from, int to) {
+    for (int i = begin; i < end; i++) {
+        face_t face = faces[adjacency[i]];
+
+        if (dead[adjacency[i]] || face.a == to || face.b == to || face.c == to) {
+            continue;
+        }
+
+        vec3_t old_normal = face_cross(vertices[face.a], vertices[face.b], vertices[face.c]);
+
+        if (face.a == from) face.a = to;
+        if (face.b == from) face.b = to;
+        if (face.c == from) face.c = to;
+
+        vec3_t new_normal = face_cross(vertices[face.a], vertices[face.b], vertices[face.c]);
+
+        float old_length = vec3_length(old_normal);
+        float new_length = vec3_length(new_normal);
+
+        if (new_length == 0 || vec3_dot(old_normal, new_normal) < MIN_COLLAPSE_NORMAL_DOT * old_length * new_length) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+face_t* simplify_mesh_faces(vec3_t* vertices, face_t* faces, int target_num_faces) {
+    int num_vertices = array_length(vertices);
+    int num_faces = array_length(faces);
+
+    if (num_vertices == 0 || num_faces == 0) {
+        return NULL;
+    }
+
+    // Work on welded copies of the faces so the input level stays untouched
+    int* canonical = weld_vertex_positions(vertices, num_vertices);
+    face_t* work_faces = (face_t*)malloc(sizeof(face_t) * num_faces);
+    char* dead = (char*)calloc(num_faces, sizeof(char));
+    int num_live_faces = num_faces;
+
+    for (int i = 0; i < num_faces; i++) {
+        work_faces[i] = faces[i];
+        work_faces[i].a = canonical[faces[i].a];
+        work_faces[i].b = canonical[faces[i].b];
+        work_faces[i].c = canonical[faces[i].c];
+
+        if (work_faces[i].a == work_faces[i].b || work_faces[i].b == work_faces[i].c || work_faces[i].c == work_faces[i].a) {
+            dead[i] = 1;
+            num_live_faces--;
+        }
+    }
+
+    // Accumulate the area weighted plane quadric of every face on its corners
+    quadric_t* quadrics = (quadric_t*)calloc(num_vertices, sizeof(quadric_t));
+    for (int i = 0; i < num_faces; i++) {
+        if (dead[i]) continue;
+
+        face_t face = work_faces[i];
+        vec3_t normal = face_cross(vertices[face.a], vertices[face.b], vertices[face.c]);
+        float length = vec3_length(normal);
+
+        if (length == 0) continue;
+
+        normal = vec3_div(normal, length);
+        double d = -vec3_dot(normal, vertices[face.a]);
+
+        for (int j = 0; j < 3; j++) {
+            quadric_add_plane(&quadrics[*face_corner(&face, j)], normal.x, normal.y, normal.z, d, length * 0.5);
+        }
+    }
+
+    int* adjacency_offset = (int*)malloc(sizeof(int) * (num_vertices + 1));
+    int* adjacency_fill = (int*)malloc(sizeof(int) * num_vertices);
+    int* adjacency = (int*)malloc(sizeof(int) * num_faces * 3);
+    int* mark = (int*)malloc(sizeof(int) * num_vertices);
+    char* locked = (char*)malloc(num_vertices);
+    char* touched = (char*)malloc(num_vertices);
+    collapse_t* collapses = (collapse_t*)malloc(sizeof(collapse_t) * num_faces * 3);
+
+    while (num_live_faces > target_num_faces) {
+        // Build the vertex to live face adjacency list
+        memset(adjacency_fill, 0, sizeof(int) * num_vertices);
+        for (int i = 0; i < num_faces; i++) {
+            if (dead[i]) continue;
+            for (int j = 0; j < 3; j++) adjacency_fill[*face_corner(&work_faces[i], j)]++;
+        }
+
+        adjacency_offset[0] = 0;
+        for (int i = 0; i < num_vertices; i++) {
+            adjacency_offset[i + 1] = adjacency_offset[i] + adjacency_fill[i];
+            adjacency_fill[i] = 0;
+        }
+
+        for (int i = 0; i < num_faces; i++) {
+            if (dead[i]) continue;
+            for (int j = 0; j < 3; j++) {
+                int vertex = *face_corner(&work_faces[i], j);
+                adjacency[adjacency_offset[vertex] + adjacency_fill[vertex]++] = i;
+            }
+        }
+
+        // Lock vertices on open boundaries (edges used by a single face) so the silhouette does not erode
+        for (int i = 0; i < num_vertices; i++) locked[i] = 0;
+        for (int i = 0; i < num_vertices; i++) mark[i] = 0;
+        for (int v = 0; v < num_vertices; v++) {
+            for (int i = adjacency_offset[v]; i < adjacency_offset[v + 1]; i++) {
+                for (int j = 0; j < 3; j++) mark[*face_corner(&work_faces[adjacency[i]], j)]++;
+            }
+            for (int i = adjacency_offset[v]; i < adjacency_offset[v + 1]; i++) {
+                for (int j = 0; j < 3; j++) {
+                    int neighbor = *face_corner(&work_faces[adjacency[i]], j);
+                    if (neighbor != v && mark[neighbor] == 1) locked[v] = 1;
+                }
+            }
+            for (int i = adjacency_offset[v]; i < adjacency_offset[v + 1]; i++) {
+                for (int j = 0; j < 3; j++) mark[*face_corner(&work_faces[adjacency[i]], j)] = 0;
+            }
+        }
+
+        // Find the cheapest direction to collapse each edge
+        int num_collapses = 0;
+        for (int i = 0; i < num_faces; i++) {
+            if (dead[i]) continue;
+
+            for (int j = 0; j < 3; j++) {
+                int u = *face_corner(&work_faces[i], j);
+                int v = *face_corner(&work_faces[i], (j + 1) % 3);
+
+                if (locked[u] && locked[v]) continue;
+
+                double cost_u_to_v = locked[u] ? INFINITY : quadric_error(&quadrics[u], &quadrics[v], vertices[v]);
+                double cost_v_to_u = locked[v] ? INFINITY : quadric_error(&quadrics[u], &quadrics[v], vertices[u]);
+
+                collapse_t collapse = {
+                    .cost = cost_u_to_v <= cost_v_to_u ? cost_u_to_v : cost_v_to_u,
+                    .from = cost_u_to_v <= cost_v_to_u ? u : v,
+                    .to = cost_u_to_v <= cost_v_to_u ? v : u
+                };
+                collapses[num_collapses++] = collapse;
+            }
+        }
+
+        qsort(collapses, num_collapses, sizeof(collapse_t), compare_collapses);
+
+        // Apply collapses in order of increasing error, each vertex at most once per pass
+        for (int i = 0; i < num_vertices; i++) touched[i] = 0;
+        int num_collapsed = 0;
+
+        for (int i = 0; i < num_collapses && num_live_faces > target_num_faces; i++) {
+            int from = collapses[i].from;
+            int to = collapses[i].to;
+            int begin = adjacency_offset[from];
+            int end = adjacency_offset[from + 1];
+
+            if (touched[from] || touched[to]) continue;
+
+            // Link condition: the endpoints may only share the neighbors of the faces that get removed
+            int num_shared_faces = 0;
+            int num_shared_neighbors = 0;
+
+            for (int f = adjacency_offset[to]; f < adjacency_offset[to + 1]; f++) {
+                if (dead[adjacency[f]]) continue;
+                for (int j = 0; j < 3; j++) mark[*face_corner(&work_faces[adjacency[f]], j)] = 1;
+            }
+            for (int f = begin; f < end; f++) {
+                face_t* face = &work_faces[adjacency[f]];
+
+                if (dead[adjacency[f]]) continue;
+                if (face->a == to || face->b == to || face->c == to) num_shared_faces++;
+
+                for (int j = 0; j < 3; j++) {
+                    int neighbor = *face_corner(face, j);
+                    if (neighbor != from && neighbor != to && mark[neighbor] == 1) {
+                        mark[neighbor] = 2;
+                        num_shared_neighbors++;
+                    }
+                }
+            }
+            for (int f = adjacency_offset[to]; f < adjacency_offset[to + 1]; f++) {
+                for (int j = 0; j < 3; j++) mark[*face_corner(&work_faces[adjacency[f]], j)] = 0;
+            }
+
+            if (num_shared_faces == 0 || num_shared_neighbors > num_shared_faces) continue;
+            if (collapse_flips_faces(vertices, work_faces, dead, adjacency, begin, end, from, to)) continue;
+
+            tex2_t to_uv;
+            if (!find_collapse_uv(work_faces, dead, adjacency, begin, end, from, to, &to_uv)) continue;
+
+            // Move every face corner from the removed vertex to the kept one, along with its UV
+            for (int f = begin; f < end; f++) {
+                face_t* face = &work_faces[adjacency[f]];
+
+                if (dead[adjacency[f]]) continue;
+
+                if (face->a == to || face->b == to || face->c == to) {
+                    dead[adjacency[f]] = 1;
+                    num_live_faces--;
+                    continue;
+                }
+
+                for (int j = 0; j < 3; j++) {
+                    if (*face_corner(face, j) == from) {
+                        *face_corner(face, j) = to;
+                        *face_corner_uv(face, j) = to_uv;
+                    }
+                }
+            }
+
+            for (int j = 0; j < 10; j++) {
+                quadrics[to].q[j] += quadrics[from].q[j];
+            }
+
+            touched[from] = 1;
+            touched[to] = 1;
+            num_collapsed++;
+        }
+
+        // Stop once no edge can be collapsed without breaking the surface
+        if (num_collapsed == 0) {
+            break;
+        }
+    }
+
+    face_t* simplified_faces = NULL;
+    for (int i = 0; i < num_faces; i++) {
+        if (!dead[i]) {
+            array_push(simplified_faces, work_faces[i]);
+        }
+    }
+
+    free(canonical);
+    free(work_faces);
+    free(dead);
+    free(quadrics);
+    free(adjacency_offset);
+    free(adjacency_fill);
+    free(adjacency);
+    free(mark);
+    free(locked);
+    free(touched);
+    free(collapses);
+
+    return simplified_faces;
+}
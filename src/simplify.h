@@ -0,0 +1,9 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "vector.h"
+#include "triangle.h"
+
+face_t* simplify_mesh_faces(vec3_t* vertices, face_t* faces, int target_num_faces);
+
+#endif
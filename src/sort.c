@@ -0,0 +1,81 @@
+#include "sort.h"
+#include <stdint.h>
+
+static int sort_method = SORT_NONE;
+
+void set_sort_method(int method) {
+    sort_method = method;
+}
+
+bool should_sort_instances(void) {
+    return sort_method == SORT_INSTANCES || sort_method == SORT_TRIANGLES;
+}
+
+bool should_sort_triangles(void) {
+    return sort_method == SORT_TRIANGLES;
+}
+
+static uint32_t get_depth_key(triangle_t* triangle) {
+    // Key on the nearest vertex, using the projected z which grows with distance and is 0..1 after clipping
+    float z = triangle->points[0].z;
+    if (triangle->points[1].z < z) z = triangle->points[1].z;
+    if (triangle->points[2].z < z) z = triangle->points[2].z;
+
+    if (z <= 0) return 0;
+    if (z >= 1) return SORT_DEPTH_BUCKETS - 1;
+    return (uint32_t)(z * (SORT_DEPTH_BUCKETS - 1));
+}
+
+triangle_t* sort_triangles_front_to_back(triangle_t* triangles, int num_triangles, arena_t* arena) {
+    if (num_triangles < 2) {
+        return triangles;
+    }
+
+    uint32_t* keys = (uint32_t*)arena_alloc(arena, sizeof(uint32_t) * num_triangles);
+    uint32_t* sorted_keys = (uint32_t*)arena_alloc(arena, sizeof(uint32_t) * num_triangles);
+    int* indices = (int*)arena_alloc(arena, sizeof(int) * num_triangles);
+    int* sorted_indices = (int*)arena_alloc(arena, sizeof(int) * num_triangles);
+
+    for (int i = 0; i < num_triangles; i++) {
+        keys[i] = get_depth_key(&triangles[i]);
+        indices[i] = i;
+    }
+
+    // Radix sort the 16-bit keys one byte at a time, which is stable so equal depths keep their order
+    for (int shift = 0; shift < 16; shift += 8) {
+        int offsets[256] = {0};
+
+        for (int i = 0; i < num_triangles; i++) {
+            offsets[(keys[i] >> shift) & 0xFF]++;
+        }
+
+        int total = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            int count = offsets[bucket];
+            offsets[bucket] = total;
+            total += count;
+        }
+
+        for (int i = 0; i < num_triangles; i++) {
+            int position = offsets[(keys[i] >> shift) & 0xFF]++;
+            sorted_keys[position] = keys[i];
+            sorted_indices[position] = indices[i];
+        }
+
+        uint32_t* swap_keys = keys;
+        keys = sorted_keys;
+        sorted_keys = swap_keys;
+
+        int* swap_indices = indices;
+        indices = sorted_indices;
+        sorted_indices = swap_indices;
+    }
+
+    // Gather the triangles in sorted order so the raster stage can still walk them linearly
+    triangle_t* sorted_triangles = (triangle_t*)arena_alloc(arena, sizeof(triangle_t) * num_triangles);
+    for (int i = 0; i < num_triangles; i++) {
+        sorted_triangles[i] = triangles[indices[i]];
+    }
+
+    return sorted_triangles;
+}
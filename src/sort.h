@@ -0,0 +1,23 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <stdbool.h>
+#include "triangle.h"
+#include "arena.h"
+
+// Number of depth buckets triangles are sorted into
+#define SORT_DEPTH_BUCKETS 65536
+
+enum sort_method {
+    SORT_NONE,
+    SORT_INSTANCES,
+    SORT_TRIANGLES
+};
+
+void set_sort_method(int method);
+bool should_sort_instances(void);
+bool should_sort_triangles(void);
+
+triangle_t* sort_triangles_front_to_back(triangle_t* triangles, int num_triangles, arena_t* arena);
+
+#endif
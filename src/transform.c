@@ -0,0 +1,150 @@
+#include "transform.h"
+
+// Batched vertex transforms that process 4 vertices per iteration with SSE2 on x86
+// and NEON on ARM, and fall back to scalar code on other targets.
+// Matrices are expected to be affine (bottom row 0, 0, 0, 1), so w is not computed,
+// except for the projection to clip space which computes all 4 rows.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRANSFORM_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSFORM_NEON
+#endif
+
+static void transform_vertex(mat4_t* m, float x, float y, float z, float** outputs, int num_rows, int i) {
+    for (int row = 0; row < num_rows; row++) {
+        outputs[row][i] = m->m[row][0] * x + m->m[row][1] * y + m->m[row][2] * z + m->m[row][3];
+    }
+}
+
+#if defined(TRANSFORM_SSE2)
+
+static void transform_block(__m128 rows[4][4], __m128 x, __m128 y, __m128 z, float** outputs, int num_rows, int i) {
+    for (int row = 0; row < num_rows; row++) {
+        __m128 sum = _mm_add_ps(_mm_mul_ps(rows[row][0], x), _mm_mul_ps(rows[row][1], y));
+        sum = _mm_add_ps(sum, _mm_add_ps(_mm_mul_ps(rows[row][2], z), rows[row][3]));
+        _mm_storeu_ps(&outputs[row][i], sum);
+    }
+}
+
+static void load_rows(mat4_t* m, __m128 rows[4][4], int num_rows) {
+    for (int row = 0; row < num_rows; row++) {
+        for (int column = 0; column < 4; column++) {
+            rows[row][column] = _mm_set1_ps(m->m[row][column]);
+        }
+    }
+}
+
+static __m128 load_quantized(uint16_t* values) {
+    // Widen 4 unsigned 16-bit values to 32-bit integers and convert them to floats
+    __m128i packed = _mm_loadl_epi64((__m128i*)values);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+}
+
+#elif defined(TRANSFORM_NEON)
+
+static void transform_block(mat4_t* m, float32x4_t x, float32x4_t y, float32x4_t z, float** outputs, int num_rows, int i) {
+    for (int row = 0; row < num_rows; row++) {
+        float32x4_t sum = vdupq_n_f32(m->m[row][3]);
+        sum = vmlaq_n_f32(sum, x, m->m[row][0]);
+        sum = vmlaq_n_f32(sum, y, m->m[row][1]);
+        sum = vmlaq_n_f32(sum, z, m->m[row][2]);
+        vst1q_f32(&outputs[row][i], sum);
+    }
+}
+
+static float32x4_t load_quantized(uint16_t* values) {
+    // Widen 4 unsigned 16-bit values to 32-bit integers and convert them to floats
+    return vcvtq_f32_u32(vmovl_u16(vld1_u16(values)));
+}
+
+#endif
+
+void transform_vertices(mat4_t* m, vec3_soa_t vertices, vec3_soa_t result, int num_vertices) {
+    float* outputs[3] = {result.x, result.y, result.z};
+    int i = 0;
+
+#if defined(TRANSFORM_SSE2)
+    __m128 rows[4][4];
+    load_rows(m, rows, 3);
+
+    for (; i + 4 <= num_vertices; i += 4) {
+        __m128 x = _mm_loadu_ps(&vertices.x[i]);
+        __m128 y = _mm_loadu_ps(&vertices.y[i]);
+        __m128 z = _mm_loadu_ps(&vertices.z[i]);
+        transform_block(rows, x, y, z, outputs, 3, i);
+    }
+#elif defined(TRANSFORM_NEON)
+    for (; i + 4 <= num_vertices; i += 4) {
+        float32x4_t x = vld1q_f32(&vertices.x[i]);
+        float32x4_t y = vld1q_f32(&vertices.y[i]);
+        float32x4_t z = vld1q_f32(&vertices.z[i]);
+        transform_block(m, x, y, z, outputs, 3, i);
+    }
+#endif
+
+    // Transform the remaining vertices one at a time
+    for (; i < num_vertices; i++) {
+        transform_vertex(m, vertices.x[i], vertices.y[i], vertices.z[i], outputs, 3, i);
+    }
+}
+
+void transform_quantized_vertices(mat4_t* m, qvec3_soa_t vertices, vec3_soa_t result, int num_vertices) {
+    float* outputs[3] = {result.x, result.y, result.z};
+    int i = 0;
+
+#if defined(TRANSFORM_SSE2)
+    __m128 rows[4][4];
+    load_rows(m, rows, 3);
+
+    for (; i + 4 <= num_vertices; i += 4) {
+        __m128 x = load_quantized(&vertices.x[i]);
+        __m128 y = load_quantized(&vertices.y[i]);
+        __m128 z = load_quantized(&vertices.z[i]);
+        transform_block(rows, x, y, z, outputs, 3, i);
+    }
+#elif defined(TRANSFORM_NEON)
+    for (; i + 4 <= num_vertices; i += 4) {
+        float32x4_t x = load_quantized(&vertices.x[i]);
+        float32x4_t y = load_quantized(&vertices.y[i]);
+        float32x4_t z = load_quantized(&vertices.z[i]);
+        transform_block(m, x, y, z, outputs, 3, i);
+    }
+#endif
+
+    // Transform the remaining vertices one at a time
+    for (; i < num_vertices; i++) {
+        transform_vertex(m, vertices.x[i], vertices.y[i], vertices.z[i], outputs, 3, i);
+    }
+}
+
+void project_vertices(mat4_t* m, vec3_soa_t vertices, vec4_soa_t result, int num_vertices) {
+    float* outputs[4] = {result.x, result.y, result.z, result.w};
+    int i = 0;
+
+#if defined(TRANSFORM_SSE2)
+    __m128 rows[4][4];
+    load_rows(m, rows, 4);
+
+    for (; i + 4 <= num_vertices; i += 4) {
+        __m128 x = _mm_loadu_ps(&vertices.x[i]);
+        __m128 y = _mm_loadu_ps(&vertices.y[i]);
+        __m128 z = _mm_loadu_ps(&vertices.z[i]);
+        transform_block(rows, x, y, z, outputs, 4, i);
+    }
+#elif defined(TRANSFORM_NEON)
+    for (; i + 4 <= num_vertices; i += 4) {
+        float32x4_t x = vld1q_f32(&vertices.x[i]);
+        float32x4_t y = vld1q_f32(&vertices.y[i]);
+        float32x4_t z = vld1q_f32(&vertices.z[i]);
+        transform_block(m, x, y, z, outputs, 4, i);
+    }
+#endif
+
+    // Project the remaining vertices one at a time
+    for (; i < num_vertices; i++) {
+        transform_vertex(m, vertices.x[i], vertices.y[i], vertices.z[i], outputs, 4, i);
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "vector.h"
+#include "matrix.h"
+#include "quantize.h"
+
+void transform_vertices(mat4_t* m, vec3_soa_t vertices, vec3_soa_t result, int num_vertices);
+void transform_quantized_vertices(mat4_t* m, qvec3_soa_t vertices, vec3_soa_t result, int num_vertices);
+void project_vertices(mat4_t* m, vec3_soa_t vertices, vec4_soa_t result, int num_vertices);
+
+#endif
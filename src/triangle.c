@@ -61,13 +61,13 @@ void draw_triangle_pixel(int x, int y, uint32_t color, vec4_t point_a, vec4_t po
     // Interpolate the value of 1/w
     float interpolated_inv_w = (1 / point_a.w) * alpha + (1 / point_b.w) * beta + (1 / point_c.w) * gamma;
 
-    // Adjust 1/w so pixels closer to the camera have a smaller value
-    interpolated_inv_w = 1 - interpolated_inv_w;
+    // Adjust 1/w so pixels closer to the camera have a smaller value, and convert it to the depth buffer format
+    uint32_t depth = get_depth_value(1 - interpolated_inv_w);
 
     // Draw pixel at (x, y) with a solid color if the pixel's z-value is less than the value previously stored in the z-buffer
-    if (interpolated_inv_w < get_z_buffer_at(x, y)) {
+    if (depth < get_z_buffer_at(x, y)) {
         draw_pixel(x, y, color);
-        update_z_buffer_at(x, y, interpolated_inv_w);
+        update_z_buffer_at(x, y, depth);
     }
 }
 
@@ -93,13 +93,21 @@ void draw_texel(int x, int y, upng_t* texture, vec4_t point_a, vec4_t point_b, v
     float point_b_inv_w = 1 / point_b.w;
     float point_c_inv_w = 1 / point_c.w;
 
+    // Interpolate the value of 1/w
+    interpolated_inv_w = point_a_inv_w * alpha + point_b_inv_w * beta + point_c_inv_w * gamma;
+
+    // Adjust 1/w so pixels closer to the camera have a smaller value, and convert it to the depth buffer format
+    uint32_t depth = get_depth_value(1.0 - interpolated_inv_w);
+
+    // Skip the texture lookup if the pixel's z-value is not less than the value previously stored in the z-buffer
+    if (depth >= get_z_buffer_at(x, y)) {
+        return;
+    }
+
     // Perform the interpolation of all U/w and V/w values using barycentric weights and a factor of 1/w
     interpolated_u = (a_uv.u * point_a_inv_w) * alpha + (b_uv.u * point_b_inv_w) * beta + (c_uv.u * point_c_inv_w) * gamma;
     interpolated_v = (a_uv.v * point_a_inv_w) * alpha + (b_uv.v * point_b_inv_w) * beta + (c_uv.v * point_c_inv_w) * gamma;
 
-    // Interpolate the value of 1/w
-    interpolated_inv_w = point_a_inv_w * alpha + point_b_inv_w * beta + point_c_inv_w * gamma;
-
     // Divide both interpolated values by 1/w 
     interpolated_u /= interpolated_inv_w;
     interpolated_v /= interpolated_inv_w;
@@ -111,26 +119,22 @@ void draw_texel(int x, int y, upng_t* texture, vec4_t point_a, vec4_t point_b, v
     // Map the UV coordinate to the full texture width and height
     int tex_x = abs((int)(interpolated_u * texture_width)) % texture_width;
     int tex_y = abs((int)(interpolated_v * texture_height)) % texture_height;
-    
-    // Adjust 1/w so pixels closer to the camera have a smaller value
-    interpolated_inv_w = 1.0 - interpolated_inv_w;
-
-    // Draw pixel at (x, y) with color from texture map only if the pixel's z-value is less than the value previously stored in the z-buffer
-    if (interpolated_inv_w < get_z_buffer_at(x, y)) {
-        // Get color buffer from texture
-        uint32_t* texture_buffer = (uint32_t*)upng_get_buffer(texture);
-
-        draw_pixel(x, y, texture_buffer[tex_y * texture_width + tex_x]);
-    
-        // Update z-buffer value with 1/w for the current pixel
-        update_z_buffer_at(x, y, interpolated_inv_w);
-    }
+
+    // Draw pixel at (x, y) with color from texture map
+    uint32_t* texture_buffer = (uint32_t*)upng_get_buffer(texture);
+    draw_pixel(x, y, texture_buffer[tex_y * texture_width + tex_x]);
+
+    // Update z-buffer value with 1/w for the current pixel
+    update_z_buffer_at(x, y, depth);
 }
 
 void draw_textured_triangle(triangle_t triangle) {
     // Initialize texture
     upng_t* texture = triangle.texture;
 
+    // Only pixels inside the region being redrawn this frame are touched
+    screen_rect_t scissor = get_dirty_rect();
+
     // Info for the first point
     int x0 = triangle.points[0].x;
     int y0 = triangle.points[0].y;
@@ -202,13 +206,21 @@ void draw_textured_triangle(triangle_t triangle) {
     if (y2 - y0 != 0) inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y1 - y0 != 0) {
-        for (int y = y0; y <= y1; y++) {
+        // Scissor rows to the redrawn region since triangles may reach into the guard band
+        int y_first = y0 > scissor.min_y ? y0 : scissor.min_y;
+        int y_last = y1 < scissor.max_y - 1 ? y1 : scissor.max_y - 1;
+
+        for (int y = y_first; y <= y_last; y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
             // Swap if x_start is to the right of x_end
             if (x_end < x_start) int_swap(&x_start, &x_end);
 
+            // Scissor the span to the redrawn region
+            if (x_start < scissor.min_x) x_start = scissor.min_x;
+            if (x_end > scissor.max_x - 1) x_end = scissor.max_x - 1;
+
             for (int x = x_start; x <= x_end; x++) {
                 // Draw pixel with the color from the texture
                 draw_texel(x, y, texture, point_a, point_b, point_c, a_uv, b_uv, c_uv);
@@ -224,13 +236,21 @@ void draw_textured_triangle(triangle_t triangle) {
     if (y2 - y0 != 0) inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y2 - y1 != 0) {
-        for (int y = y1; y <= y2; y++) {
+        // Scissor rows to the redrawn region since triangles may reach into the guard band
+        int y_first = y1 > scissor.min_y ? y1 : scissor.min_y;
+        int y_last = y2 < scissor.max_y - 1 ? y2 : scissor.max_y - 1;
+
+        for (int y = y_first; y <= y_last; y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
             // Swap if x_start is to the right of x_end
             if (x_end < x_start) int_swap(&x_start, &x_end);
 
+            // Scissor the span to the redrawn region
+            if (x_start < scissor.min_x) x_start = scissor.min_x;
+            if (x_end > scissor.max_x - 1) x_end = scissor.max_x - 1;
+
             for (int x = x_start; x <= x_end; x++) {
                 // Draw pixel with the color from the texture
                 draw_texel(x, y, texture, point_a, point_b, point_c, a_uv, b_uv, c_uv);
@@ -240,6 +260,9 @@ void draw_textured_triangle(triangle_t triangle) {
 }
 
 void draw_filled_triangle(triangle_t triangle, uint32_t color) {
+    // Only pixels inside the region being redrawn this frame are touched
+    screen_rect_t scissor = get_dirty_rect();
+
     // Info for the first point
     int x0 = triangle.points[0].x;
     int y0 = triangle.points[0].y;
@@ -291,13 +314,21 @@ void draw_filled_triangle(triangle_t triangle, uint32_t color) {
     if (y2 - y0 != 0) inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y1 - y0 != 0) {
-        for (int y = y0; y <= y1; y++) {
+        // Scissor rows to the redrawn region since triangles may reach into the guard band
+        int y_first = y0 > scissor.min_y ? y0 : scissor.min_y;
+        int y_last = y1 < scissor.max_y - 1 ? y1 : scissor.max_y - 1;
+
+        for (int y = y_first; y <= y_last; y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
             // Swap if x_start is to the right of x_end
             if (x_end < x_start) int_swap(&x_start, &x_end);
 
+            // Scissor the span to the redrawn region
+            if (x_start < scissor.min_x) x_start = scissor.min_x;
+            if (x_end > scissor.max_x - 1) x_end = scissor.max_x - 1;
+
             for (int x = x_start; x <= x_end; x++) {
                 // Draw pixel with color
                 draw_triangle_pixel(x, y, color, point_a, point_b, point_c);
@@ -313,13 +344,21 @@ void draw_filled_triangle(triangle_t triangle, uint32_t color) {
     if (y2 - y0 != 0) inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y2 - y1 != 0) {
-        for (int y = y1; y <= y2; y++) {
+        // Scissor rows to the redrawn region since triangles may reach into the guard band
+        int y_first = y1 > scissor.min_y ? y1 : scissor.min_y;
+        int y_last = y2 < scissor.max_y - 1 ? y2 : scissor.max_y - 1;
+
+        for (int y = y_first; y <= y_last; y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
             // Swap if x_start is to the right of x_end
             if (x_end < x_start) int_swap(&x_start, &x_end);
 
+            // Scissor the span to the redrawn region
+            if (x_start < scissor.min_x) x_start = scissor.min_x;
+            if (x_end > scissor.max_x - 1) x_end = scissor.max_x - 1;
+
             for (int x = x_start; x <= x_end; x++) {
                 // Draw pixel with color
                 draw_triangle_pixel(x, y, color, point_a, point_b, point_c);
@@ -13,6 +13,21 @@ typedef struct {
     float x, y, z, w;
 } vec4_t;
 
+// Array of 3D vectors stored as separate x, y and z arrays for batched processing
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+} vec3_soa_t;
+
+// Array of 4D vectors stored as separate x, y, z and w arrays for batched processing
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+    float* w;
+} vec4_soa_t;
+
 // 2D vector functions
 vec2_t vec2_new(float x, float y);
 float vec2_length(vec2_t v);
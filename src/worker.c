@@ -0,0 +1,171 @@
+#include "worker.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+typedef struct {
+    SDL_Thread* thread;
+    SDL_sem* start_sem;
+    int index;
+} worker_t;
+
+// Worker 0 is the calling thread, so only the others get a thread of their own
+static worker_t workers[MAX_WORKERS];
+static int num_workers = 1;
+
+static SDL_sem* done_sem = NULL;
+static SDL_atomic_t is_stopping;
+
+// Job of the current run, written before the workers are started
+static worker_job_t current_job = NULL;
+static void* current_data = NULL;
+static int current_num_workers = 1;
+
+// Single thread outside the pool that runs one job at a time alongside the calling thread
+static SDL_Thread* background_thread = NULL;
+static SDL_sem* background_start_sem = NULL;
+static SDL_sem* background_done_sem = NULL;
+static background_job_t background_job = NULL;
+static void* background_data = NULL;
+static bool is_background_job_running = false;
+
+static int worker_thread_main(void* data) {
+    worker_t* worker = (worker_t*)data;
+
+    while (true) {
+        SDL_SemWait(worker->start_sem);
+
+        if (SDL_AtomicGet(&is_stopping)) {
+            break;
+        }
+
+        current_job(worker->index, current_num_workers, current_data);
+        SDL_SemPost(done_sem);
+    }
+
+    return 0;
+}
+
+static int background_thread_main(void* data) {
+    (void)data;
+    while (true) {
+        SDL_SemWait(background_start_sem);
+
+        if (SDL_AtomicGet(&is_stopping)) {
+            break;
+        }
+
+        background_job(background_data);
+        SDL_SemPost(background_done_sem);
+    }
+
+    return 0;
+}
+
+void init_workers(void) {
+    SDL_AtomicSet(&is_stopping, 0);
+    done_sem = SDL_CreateSemaphore(0);
+
+    // Use one thread per core, the calling thread included
+    int num_cores = SDL_GetCPUCount();
+    if (num_cores > MAX_WORKERS) num_cores = MAX_WORKERS;
+
+    num_workers = 1;
+    for (int i = 1; i < num_cores; i++) {
+        worker_t* worker = &workers[num_workers];
+        worker->index = num_workers;
+        worker->start_sem = SDL_CreateSemaphore(0);
+        worker->thread = SDL_CreateThread(worker_thread_main, "geometry worker", worker);
+
+        if (!worker->thread) {
+            fprintf(stderr, "Error creating worker thread.\n");
+            SDL_DestroySemaphore(worker->start_sem);
+            break;
+        }
+        num_workers++;
+    }
+
+    background_start_sem = SDL_CreateSemaphore(0);
+    background_done_sem = SDL_CreateSemaphore(0);
+    background_thread = SDL_CreateThread(background_thread_main, "background worker", NULL);
+
+    if (!background_thread) {
+        fprintf(stderr, "Error creating background thread.\n");
+    }
+}
+
+int get_num_workers(void) {
+    return num_workers;
+}
+
+void run_workers(worker_job_t job, void* data, int requested_workers) {
+    if (requested_workers > num_workers) requested_workers = num_workers;
+    if (requested_workers < 1) requested_workers = 1;
+
+    // Run small jobs on the calling thread without waking anyone
+    if (requested_workers == 1) {
+        job(0, 1, data);
+        return;
+    }
+
+    current_job = job;
+    current_data = data;
+    current_num_workers = requested_workers;
+
+    for (int i = 1; i < requested_workers; i++) {
+        SDL_SemPost(workers[i].start_sem);
+    }
+
+    job(0, requested_workers, data);
+
+    // Wait for every other worker to finish its range
+    for (int i = 1; i < requested_workers; i++) {
+        SDL_SemWait(done_sem);
+    }
+}
+
+void start_background_job(background_job_t job, void* data) {
+    // Without a background thread the job runs to completion right away
+    if (!background_thread) {
+        job(data);
+        return;
+    }
+
+    background_job = job;
+    background_data = data;
+    is_background_job_running = true;
+    SDL_SemPost(background_start_sem);
+}
+
+void wait_background_job(void) {
+    if (is_background_job_running) {
+        SDL_SemWait(background_done_sem);
+        is_background_job_running = false;
+    }
+}
+
+void destroy_workers(void) {
+    wait_background_job();
+    SDL_AtomicSet(&is_stopping, 1);
+
+    if (background_thread) {
+        SDL_SemPost(background_start_sem);
+        SDL_WaitThread(background_thread, NULL);
+        background_thread = NULL;
+    }
+    if (background_start_sem) SDL_DestroySemaphore(background_start_sem);
+    if (background_done_sem) SDL_DestroySemaphore(background_done_sem);
+    background_start_sem = NULL;
+    background_done_sem = NULL;
+
+    for (int i = 1; i < num_workers; i++) {
+        SDL_SemPost(workers[i].start_sem);
+        SDL_WaitThread(workers[i].thread, NULL);
+        SDL_DestroySemaphore(workers[i].start_sem);
+        workers[i].thread = NULL;
+    }
+    num_workers = 1;
+
+    if (done_sem) SDL_DestroySemaphore(done_sem);
+    done_sem = NULL;
+}
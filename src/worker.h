@@ -0,0 +1,20 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+// Maximum number of threads splitting a job, including the calling thread
+#define MAX_WORKERS 16
+
+// Job run on every worker with its index, so each one can pick its own range of the work
+typedef void (*worker_job_t)(int worker_index, int num_workers, void* data);
+
+// Job run on the background thread while the calling thread continues with other work
+typedef void (*background_job_t)(void* data);
+
+void init_workers(void);
+int get_num_workers(void);
+void run_workers(worker_job_t job, void* data, int num_workers);
+void start_background_job(background_job_t job, void* data);
+void wait_background_job(void);
+void destroy_workers(void);
+
+#endif